@@ -0,0 +1,42 @@
+# (C) 2020-2021 by folkert van heusden <mail@vanheusden.com>, released under Apache License v2.0
+# generates a constexpr table, indexed by information element id, from the
+# IANA IPFIX information elements csv (https://www.iana.org/assignments/ipfix/ipfix-information-elements.csv)
+# usage: cmake -DCSV=<csv-file> -DOUT=<header> -P generate-ie-registry.cmake
+
+# the description column can span multiple lines: only lines that start
+# with an id, name and data type are used; ranges and reserved entries
+# (no data type) are skipped
+file(STRINGS ${CSV} lines REGEX "^[0-9]+,[A-Za-z0-9]+,[A-Za-z0-9]+")
+
+set(max_id 0)
+
+foreach(line ${lines})
+	if (line MATCHES "^([0-9]+),([A-Za-z0-9]+),([A-Za-z0-9]+)")
+		set(id ${CMAKE_MATCH_1})
+		set(name_${id} ${CMAKE_MATCH_2})
+		set(type_${id} ${CMAKE_MATCH_3})
+
+		if (id GREATER max_id)
+			set(max_id ${id})
+		endif()
+	endif()
+endforeach()
+
+get_filename_component(csv_name ${CSV} NAME)
+
+set(out "// generated from ${csv_name}, do not edit\n")
+# ie_registry_entry_t is in ipfix-common.h, which must be included first
+string(APPEND out "#pragma once\n\n\n")
+string(APPEND out "constexpr ie_registry_entry_t ie_registry[] = {\n")
+
+foreach(id RANGE ${max_id})
+	if (DEFINED name_${id})
+		string(APPEND out "\t{ \"${name_${id}}\", dt_${type_${id}}, ${id} },\n")
+	else()
+		string(APPEND out "\t{ nullptr, dt_reserved, ${id} },\n")
+	endif()
+endforeach()
+
+string(APPEND out "};\n\nconstexpr uint16_t ie_registry_size = sizeof(ie_registry) / sizeof(ie_registry[0]);\n")
+
+file(WRITE ${OUT} "${out}")
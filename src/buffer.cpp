@@ -133,6 +133,15 @@ const uint8_t *buffer::get_bytes(const int len)
 
 uint64_t get_variable_size_integer(buffer & data_source, const int len)
 {
+	if (len == 2)
+		return data_source.get_net_short();
+
+	if (len == 4)
+		return data_source.get_net_long();
+
+	if (len == 8)
+		return data_source.get_net_long_long();
+
 	uint64_t out = 0;
 
 	for(int i=0; i<len; i++) {
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <endian.h>
 #include <stdint.h>
+#include <string.h>
 #include <string>
 
 
@@ -38,3 +40,33 @@ public:
 };
 
 uint64_t get_variable_size_integer(buffer & data_source, const int len);
+
+// non-virtual and non-throwing: check once with has() that enough bytes are
+// left, then use the unchecked getters; the checked ones return false
+// instead of throwing
+class buffer_view
+{
+private:
+	const uint8_t *p    { nullptr };
+	int            size { 0 };
+	int            o    { 0 };
+
+public:
+	buffer_view() { }
+	buffer_view(const uint8_t *const p, const int size) : p(p), size(size) { }
+
+	bool            has(const int len) const { return len >= 0 && size - o >= len; }
+
+	uint8_t         get_byte_unchecked() { return p[o++]; }
+	uint16_t        get_net_short_unchecked() { uint16_t v; memcpy(&v, &p[o], 2); o += 2; return be16toh(v); }
+	uint32_t        get_net_long_unchecked() { uint32_t v; memcpy(&v, &p[o], 4); o += 4; return be32toh(v); }
+	const uint8_t * get_bytes_unchecked(const int len) { const uint8_t *temp = &p[o]; o += len; return temp; }
+
+	bool            get_byte(uint8_t *const out) { if (!has(1)) return false; *out = get_byte_unchecked(); return true; }
+	bool            get_net_short(uint16_t *const out) { if (!has(2)) return false; *out = get_net_short_unchecked(); return true; }
+	bool            get_net_long(uint32_t *const out) { if (!has(4)) return false; *out = get_net_long_unchecked(); return true; }
+	bool            get_segment(const int len, buffer_view *const out) { if (!has(len)) return false; *out = buffer_view(get_bytes_unchecked(len), len); return true; }
+
+	bool            end_reached() const { return o == size; }
+	int             get_n_bytes_left() const { return size - o; }
+};
@@ -0,0 +1,167 @@
+#include <stddef.h>
+#include <stdint.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "column-decode.h"
+#include "logging.h"
+#include "net.h"
+
+
+typedef void (*decode_kernel_t)(const decode_plan_t & plan, const uint8_t *const records, const size_t first, const size_t n, db_record_batch_t *const out);
+
+static void decode_scalar(const decode_plan_t & plan, const uint8_t *const records, const size_t first, const size_t n, db_record_batch_t *const out)
+{
+	for(auto & field : plan.fields) {
+		if (field.integer == false)
+			continue;
+
+		uint64_t *target = out->columns[field.column].integers.data();
+
+		for(size_t i=first; i<n; i++) {
+			const uint8_t *p = &records[i * plan.record_length + field.offset];
+
+			switch(field.field_length) {
+				case 1:
+					target[i] = p[0];
+					break;
+				case 2:
+					target[i] = get_net_short(p);
+					break;
+				case 4:
+					target[i] = get_net_long(p);
+					break;
+				case 8:
+					target[i] = get_net_long_long(p);
+					break;
+				default: {
+						uint64_t v = 0;
+
+						for(int b=0; b<field.field_length; b++)
+							v = (v << 8) | p[b];
+
+						target[i] = v;
+					}
+					break;
+			}
+		}
+	}
+}
+
+#if defined(__x86_64__)
+__attribute__((target("ssse3")))
+static void decode_ssse3(const decode_plan_t & plan, const uint8_t *const records, const size_t first, const size_t n, db_record_batch_t *const out)
+{
+	for(auto & chunk : plan.swap_chunks) {
+		const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(chunk.shuffle));
+
+		uint64_t *target0 = out->columns[chunk.column[0]].integers.data();
+		uint64_t *target1 = chunk.column[1] != -1 ? out->columns[chunk.column[1]].integers.data() : nullptr;
+
+		for(size_t i=first; i<n; i++) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&records[i * plan.record_length + chunk.offset]));
+
+			v = _mm_shuffle_epi8(v, mask);
+
+			target0[i] = _mm_cvtsi128_si64(v);
+
+			if (target1)
+				target1[i] = _mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v));
+		}
+	}
+}
+
+// two records per shuffle
+__attribute__((target("avx2")))
+static void decode_avx2(const decode_plan_t & plan, const uint8_t *const records, const size_t first, const size_t n, db_record_batch_t *const out)
+{
+	const size_t n_pairs_end = first + (n - first) / 2 * 2;
+
+	for(auto & chunk : plan.swap_chunks) {
+		const __m256i mask = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(chunk.shuffle)));
+
+		uint64_t *target0 = out->columns[chunk.column[0]].integers.data();
+		uint64_t *target1 = chunk.column[1] != -1 ? out->columns[chunk.column[1]].integers.data() : nullptr;
+
+		for(size_t i=first; i<n_pairs_end; i += 2) {
+			const uint8_t *p = &records[i * plan.record_length + chunk.offset];
+
+			__m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))),
+					_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + plan.record_length)), 1);
+
+			v = _mm256_shuffle_epi8(v, mask);
+
+			target0[i    ] = _mm256_extract_epi64(v, 0);
+			target0[i + 1] = _mm256_extract_epi64(v, 2);
+
+			if (target1) {
+				target1[i    ] = _mm256_extract_epi64(v, 1);
+				target1[i + 1] = _mm256_extract_epi64(v, 3);
+			}
+		}
+	}
+
+	if (n_pairs_end < n)
+		decode_ssse3(plan, records, n_pairs_end, n, out);
+}
+#endif
+
+static decode_kernel_t select_kernel()
+{
+#if defined(__x86_64__)
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2")) {
+		dolog(ll_debug, "decode_integer_columns: using AVX2");
+
+		return decode_avx2;
+	}
+
+	if (__builtin_cpu_supports("ssse3")) {
+		dolog(ll_debug, "decode_integer_columns: using SSSE3");
+
+		return decode_ssse3;
+	}
+#endif
+
+	return nullptr;
+}
+
+void decode_integer_columns(const decode_plan_t & plan, const uint8_t *const records, const size_t n, const size_t n_bytes_available, db_record_batch_t *const out)
+{
+	static const decode_kernel_t kernel = select_kernel();
+
+	for(auto & field : plan.fields) {
+		if (field.integer)
+			out->columns[field.column].integers.resize(n);
+	}
+
+	// the 16 byte loads must stay within the set
+	size_t n_vector = 0;
+
+	if (kernel && n_bytes_available >= size_t(plan.swap_reach)) {
+		n_vector = (n_bytes_available - plan.swap_reach) / plan.record_length + 1;
+
+		if (n_vector > n)
+			n_vector = n;
+
+		kernel(plan, records, 0, n_vector, out);
+	}
+
+	decode_scalar(plan, records, n_vector, n, out);
+
+	// reduced size signed integers
+	for(auto & field : plan.fields) {
+		if (field.integer == false || field.field_length == 8)
+			continue;
+
+		if (field.type != dt_signed8 && field.type != dt_signed16 && field.type != dt_signed32 && field.type != dt_signed64)
+			continue;
+
+		const int shift = 64 - field.field_length * 8;
+
+		for(auto & v : out->columns[field.column].integers)
+			v = uint64_t(int64_t(v << shift) >> shift);
+	}
+}
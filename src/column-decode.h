@@ -0,0 +1,12 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "db-common.h"
+#include "decode-plan.h"
+
+
+// byte swaps (and widens) the integer fields of 'n' fixed length records into
+// db_column_t::integers; uses AVX2 or SSSE3 when the cpu has it
+// n_bytes_available: readable bytes from 'records' on (at least n * record_length)
+void decode_integer_columns(const decode_plan_t & plan, const uint8_t *const records, const size_t n, const size_t n_bytes_available, db_record_batch_t *const out);
@@ -4,34 +4,115 @@
 #include <string>
 #include <stdint.h>
 #include <thread>
+#include <tuple>
 #include <vector>
 
 #include "buffer.h"
 #include "ipfix-common.h"
+#include "packet.h"
 
 
 // (no-)SQL
+constexpr int db_record_max_fields = 64;
+
 typedef struct
 {
-	buffer      b;
+	uint16_t    field_id;  // see fields::get_field_id()
 	data_type_t dt;
-	int         len;
-} db_record_data_t;
+	// of the value in the datagram (db_record_t::base)
+	uint16_t    offset;
+	uint16_t    len;
+} db_record_field_t;
+
+// fixed size (no allocations), so cheap to copy
+class db_record_t
+{
+private:
+	db_record_field_t fields[db_record_max_fields];
+	int               n_fields { 0 };
+	uint64_t          present[field_id_max / 64] { 0 };
+
+public:
+	time_t            export_time           { 0 };
+	uint32_t          sequence_number       { 0 };
+	uint32_t          observation_domain_id { 0 };
+	// hash_address() of the exporter
+	uint64_t          exporter              { 0 };
+
+	// the datagram the values are in
+	const uint8_t    *base                  { nullptr };
+	// keeps 'base' alive (when it is in a pool buffer)
+	packet_ref        packet;
+
+	// false when the record is full or the value is not in 'base'
+	bool add(const uint16_t field_id, const data_type_t dt, const uint8_t *const value, const int len) {
+		if (n_fields == db_record_max_fields || field_id >= field_id_max || value < base || size_t(value - base) + len > 65535)
+			return false;
+
+		fields[n_fields++] = { field_id, dt, uint16_t(value - base), uint16_t(len) };
+		present[field_id / 64] |= uint64_t(1) << (field_id % 64);
+
+		return true;
+	}
+
+	bool has(const uint16_t field_id) const { return field_id < field_id_max && (present[field_id / 64] >> (field_id % 64)) & 1; }
+
+	// index in [0, size()) or -1
+	int find(const uint16_t field_id) const {
+		if (has(field_id) == false)
+			return -1;
+
+		for(int i=0; i<n_fields; i++) {
+			if (fields[i].field_id == field_id)
+				return i;
+		}
+
+		return -1;
+	}
+
+	int                       size() const { return n_fields; }
+	const db_record_field_t & get(const int index) const { return fields[index]; }
+	const uint8_t           * get_value(const int index) const { return base + fields[index].offset; }
+	buffer                    get_buffer(const int index) const { return buffer(get_value(index), fields[index].len); }
+};
+
+// the records of one data set, column-wise: one column per field of the
+// template, with one value per record
+typedef struct
+{
+	const char                  *name;
+	uint16_t                     field_id;
+	data_type_t                  dt;
+	// where the value of each record is (in the datagram) and its length
+	std::vector<const uint8_t *> values;
+	std::vector<int>             lengths;
+	// byte swapped and widened to 64 bit (sign extended for signed types);
+	// only for integer columns of fixed length templates, else empty (the
+	// influxdb aggregation sums these directly)
+	std::vector<uint64_t>        integers;
+} db_column_t;
 
 typedef struct
 {
-	time_t   export_time;
-	uint32_t sequence_number;
-	uint32_t observation_domain_id;
+	time_t                   export_time;
+	uint32_t                 sequence_number;
+	uint32_t                 observation_domain_id;
+	uint64_t                 exporter;
+
+	size_t                   n_records;
+	std::vector<db_column_t> columns;
 
-	// key, value
-	std::map<std::string, db_record_data_t> data;
-} db_record_t;
+	// see db_record_t
+	const uint8_t           *base;
+	packet_ref               packet;
+} db_record_batch_t;
 
 typedef struct
 {
 	std::string target_name;
 	bool        target_is_json;
+	// -1 when the (IANA) name is not known
+	int         field_id;
 } db_field_t;
 
 typedef struct
@@ -41,6 +122,16 @@ typedef struct
 	std::string unmapped_fields;
 } db_field_mappings_t;
 
+// db_sql collects rows and writes them with one multi-row INSERT when one
+// of these is reached (and when it stops)
+typedef struct
+{
+	int    max_rows;
+	size_t max_bytes;
+	// 0: only when max_rows or max_bytes is reached
+	int    max_delay_ms;
+} db_sql_batching_t;
+
 // time series
 
 typedef struct
@@ -50,7 +141,8 @@ typedef struct
 	int                           emit_interval;
 	std::string                   publish_topic;
 	std::string                   type;
-	std::vector<std::pair<std::string, std::string > > rules;
+	// field, field id (-1 if not known), value
+	std::vector<std::tuple<std::string, int, std::string> > rules;
 
 	// measurements
 	std::mutex                   *lock;
@@ -8,13 +8,22 @@
 #include "logging.h"
 #include "net.h"
 #include "str.h"
+#include "value-format.h"
 
 
 db_influxdb::db_influxdb(const std::string & host, const int port, db_timeseries_aggregations_t & aggregations) :
 	db_timeseries(aggregations),
-	host(host), port(port)
+	host(host), port(port),
+	aggregation_by_field_id(field_id_max)
 {
 	for(auto & element : this->aggregations.aggregations) {
+		auto field_id = field_lookup.get_field_id(element.first);
+
+		if (field_id.has_value())
+			aggregation_by_field_id.at(field_id.value()) = &element.second;
+		else
+			dolog(ll_warning, "db_influxdb: field \"%s\" is not known, it will not be aggregated", element.first.c_str());
+
 		element.second.lock      = new std::mutex();
 		element.second.total     = 0;
 		element.second.n_samples = 0;
@@ -31,6 +40,27 @@ void db_influxdb::init_database()
 {
 }
 
+// the aggregated fields and the fields the rules check
+std::optional<field_projection_t> db_influxdb::get_projection() const
+{
+	field_projection_t projection;
+
+	for(size_t field_id=0; field_id<aggregation_by_field_id.size(); field_id++) {
+		db_aggregation_t *aggregation = aggregation_by_field_id.at(field_id);
+		if (!aggregation)
+			continue;
+
+		projection.set(field_id);
+
+		for(auto & rule : aggregation->rules) {
+			if (std::get<1>(rule) != -1)
+				projection.set(std::get<1>(rule));
+		}
+	}
+
+	return projection;
+}
+
 void db_influxdb::aggregate(db_aggregation_t & element)
 {
         while(time(nullptr) % element.emit_interval)
@@ -86,43 +116,32 @@ void db_influxdb::aggregate(db_aggregation_t & element)
 
 bool db_influxdb::insert(const db_record_t & dr)
 {
-	db_record_t work = dr;
+	for(int i=0; i<dr.size(); i++) {
+		const db_record_field_t & element = dr.get(i);
 
-	for(auto & element : work.data) {
-		// find aggregation (if any) by name of the flow-element
-		auto it = aggregations.aggregations.find(element.first);
-		if (it == aggregations.aggregations.end())
+		// find aggregation (if any) of the flow-element
+		db_aggregation_t *aggregation = aggregation_by_field_id.at(element.field_id);
+		if (!aggregation)
 			continue;
 
-		std::unique_lock lck(*it->second.lock);
+		std::unique_lock lck(*aggregation->lock);
 
 		// check the rules if any
 		bool use = true;
 
-		for(auto & rule : it->second.rules) {
-			// get field from work.data
-			auto field_it = work.data.find(rule.first);
+		for(auto & rule : aggregation->rules) {
+			// get field from the record
+			int index = std::get<1>(rule) == -1 ? -1 : dr.find(std::get<1>(rule));
 
 			// field not in set? then this rule doesn't
 			// match, abort
-			if (field_it == work.data.end()) {
+			if (index == -1) {
 				use = false;
 				break;
 			}
 
-			// get the (processed) value of the field
-			auto value = ipfix::data_to_str(field_it->second.dt, field_it->second.len, field_it->second.b);
-
-			// can't process this field, abort rule(s)
-			if (value.has_value() == false) {
-				dolog(ll_info, "db_influxdb::insert: cannot retrieve value from field \"%s\"", rule.first.c_str());
-
-				use = false;
-				break;
-			}
-
-			// contents mismatch
-			if (value.value() != rule.second) {
+			// contents mismatch (or the value cannot be processed)
+			if (value_equals(dr.get(index).dt, dr.get_value(index), dr.get(index).len, std::get<2>(rule)) == false) {
 				use = false;
 				break;
 			}
@@ -130,22 +149,22 @@ bool db_influxdb::insert(const db_record_t & dr)
 
 		if (use) {
 			// update record with sample value
-			if (element.second.dt == dt_unsigned8 ||
-			    element.second.dt == dt_unsigned16 ||
-			    element.second.dt == dt_unsigned32 ||
-			    element.second.dt == dt_unsigned64 ||
-			    element.second.dt == dt_signed8 ||
-			    element.second.dt == dt_signed16 ||
-			    element.second.dt == dt_signed32 ||
-			    element.second.dt == dt_signed64) {
-				auto value = ipfix::data_to_str(element.second.dt, element.second.len, element.second.b);
-
-				if (value.has_value() == true) {
-					it->second.total += std::atoll(value.value().c_str());
-					it->second.n_samples++;
+			if (element.dt == dt_unsigned8 ||
+			    element.dt == dt_unsigned16 ||
+			    element.dt == dt_unsigned32 ||
+			    element.dt == dt_unsigned64 ||
+			    element.dt == dt_signed8 ||
+			    element.dt == dt_signed16 ||
+			    element.dt == dt_signed32 ||
+			    element.dt == dt_signed64) {
+				int64_t value = 0;
+
+				if (get_integer_value(element.dt, dr.get_value(i), element.len, &value)) {
+					aggregation->total += value;
+					aggregation->n_samples++;
 				}
 				else {
-					dolog(ll_info, "db_influxdb::insert: cannot retrieve value from field \"%s\"", element.first.c_str());
+					dolog(ll_info, "db_influxdb::insert: cannot retrieve value from field \"%s\"", field_lookup.get_name(element.field_id));
 				}
 			}
 
@@ -156,3 +175,86 @@ bool db_influxdb::insert(const db_record_t & dr)
 
 	return true;
 }
+
+// column-wise: the rules are resolved once per column and the samples of
+// all records are summed under one lock; integer columns of fixed length
+// templates come byte swapped already (column-decode)
+bool db_influxdb::insert_batch(const db_record_batch_t & batch)
+{
+	for(auto & column : batch.columns) {
+		db_aggregation_t *aggregation = aggregation_by_field_id.at(column.field_id);
+		if (!aggregation)
+			continue;
+
+		if (column.dt != dt_unsigned8 &&
+		    column.dt != dt_unsigned16 &&
+		    column.dt != dt_unsigned32 &&
+		    column.dt != dt_unsigned64 &&
+		    column.dt != dt_signed8 &&
+		    column.dt != dt_signed16 &&
+		    column.dt != dt_signed32 &&
+		    column.dt != dt_signed64)
+			continue;
+
+		// the columns the rules check; a field that is not in the set
+		// matches no record
+		std::vector<const db_column_t *> rule_columns;
+		bool use = true;
+
+		for(auto & rule : aggregation->rules) {
+			const db_column_t *rule_column = nullptr;
+
+			for(auto & candidate : batch.columns) {
+				if (std::get<1>(rule) != -1 && candidate.field_id == std::get<1>(rule)) {
+					rule_column = &candidate;
+					break;
+				}
+			}
+
+			if (!rule_column) {
+				use = false;
+				break;
+			}
+
+			rule_columns.push_back(rule_column);
+		}
+
+		if (use == false)
+			continue;
+
+		const bool swapped   = column.integers.size() == batch.n_records;
+		uint64_t   total     = 0;
+		uint64_t   n_samples = 0;
+
+		for(size_t i=0; i<batch.n_records; i++) {
+			bool match = true;
+
+			for(size_t r=0; r<rule_columns.size() && match; r++)
+				match = value_equals(rule_columns[r]->dt, rule_columns[r]->values[i], rule_columns[r]->lengths[i], std::get<2>(aggregation->rules[r]));
+
+			if (match == false)
+				continue;
+
+			int64_t value = 0;
+
+			if (swapped)
+				value = int64_t(column.integers[i]);
+			else if (get_integer_value(column.dt, column.values[i], column.lengths[i], &value) == false) {
+				dolog(ll_info, "db_influxdb::insert_batch: cannot retrieve value from field \"%s\"", column.name);
+				continue;
+			}
+
+			total += uint64_t(value);
+			n_samples++;
+		}
+
+		if (n_samples) {
+			std::unique_lock lck(*aggregation->lock);
+
+			aggregation->total     += total;
+			aggregation->n_samples += n_samples;
+		}
+	}
+
+	return true;
+}
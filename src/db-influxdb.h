@@ -8,6 +8,9 @@ private:
 	const std::string host;
 	const int         port;
 
+	// points into 'aggregations', nullptr for fields that are not aggregated
+	std::vector<db_aggregation_t *> aggregation_by_field_id;
+
 	std::string unescape(const db_record_t & dr, const std::string & name);
 
 	void        aggregate(db_aggregation_t & element);
@@ -19,5 +22,10 @@ public:
 	db_influxdb(const std::string & host, const int port, db_timeseries_aggregations_t & aggregations);
 	virtual ~db_influxdb();
 
+	bool is_thread_safe() const override { return true; }
+
+	std::optional<field_projection_t> get_projection() const override;
+
 	bool insert(const db_record_t & dr) override;
+	bool insert_batch(const db_record_batch_t & batch) override;
 };
@@ -44,10 +44,15 @@ bool db_mongodb::insert(const db_record_t & dr)
 
 	bsoncxx::builder::basic::document sub_doc;
 
-	for(auto & element : dr.data) {
-		db_record_data_t element_data = element.second;
+	for(int i=0; i<dr.size(); i++) {
+		const db_record_field_t & element_data = dr.get(i);
+		buffer                    b            = dr.get_buffer(i);
 
-		std::string key_name = element.first;
+		const char *name = field_lookup.get_name(element_data.field_id);
+		if (!name)
+			continue;
+
+		std::string key_name = name;
 
 		auto it = field_mappings.mappings.find(key_name);
 		if (it != field_mappings.mappings.end())
@@ -58,7 +63,7 @@ bool db_mongodb::insert(const db_record_t & dr)
 			case dt_ipv4Address:
 			case dt_ipv6Address:
 			case dt_macAddress: {
-					const uint8_t *bytes = element_data.b.get_bytes(element_data.len);
+					const uint8_t *bytes = b.get_bytes(element_data.len);
 
 					bsoncxx::types::b_binary binary_data;
 					binary_data.size = element_data.len;
@@ -69,18 +74,18 @@ bool db_mongodb::insert(const db_record_t & dr)
 				break;
 
 			case dt_unsigned8:
-				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, element_data.b.get_byte()));
+				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, b.get_byte()));
 				break;
 
 			case dt_unsigned16: {
-					uint16_t temp = get_variable_size_integer(element_data.b, element_data.len);
+					uint16_t temp = get_variable_size_integer(b, element_data.len);
 
 					sub_doc.append(bsoncxx::builder::basic::kvp(key_name, temp));
 				}
 				break;
 
 			case dt_unsigned32: {
-					uint32_t temp = get_variable_size_integer(element_data.b, element_data.len);
+					uint32_t temp = get_variable_size_integer(b, element_data.len);
 
 					if (temp > 2147483647) 
 						sub_doc.append(bsoncxx::builder::basic::kvp(key_name, int64_t(temp)));
@@ -90,7 +95,7 @@ bool db_mongodb::insert(const db_record_t & dr)
 				break;
 
 			case dt_unsigned64: {
-					uint64_t temp = get_variable_size_integer(element_data.b, element_data.len);
+					uint64_t temp = get_variable_size_integer(b, element_data.len);
 
 					// hope for the best! (will fail when value > 0x7fffffffffffffff)
 					sub_doc.append(bsoncxx::builder::basic::kvp(key_name, int64_t(temp)));
@@ -98,31 +103,31 @@ bool db_mongodb::insert(const db_record_t & dr)
 				break;
 
 			case dt_signed8:
-				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, element_data.b.get_byte()));
+				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, b.get_byte()));
 				break;
 
 			case dt_signed16:
-				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, element_data.b.get_net_short()));
+				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, b.get_net_short()));
 				break;
 
 			case dt_signed32:
-				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, int32_t(element_data.b.get_net_long())));
+				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, int32_t(b.get_net_long())));
 				break;
 
 			case dt_signed64:
-				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, int64_t(element_data.b.get_net_long_long())));
+				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, int64_t(b.get_net_long_long())));
 				break;
 
 			case dt_float32:
-				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, element_data.b.get_net_float()));
+				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, b.get_net_float()));
 				break;
 
 			case dt_float64:
-				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, element_data.b.get_net_double()));
+				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, b.get_net_double()));
 				break;
 
 			case dt_boolean: {
-					uint8_t v = element_data.b.get_byte();
+					uint8_t v = b.get_byte();
 
 					if (v == 1)
 						sub_doc.append(bsoncxx::builder::basic::kvp(key_name, true));
@@ -134,15 +139,15 @@ bool db_mongodb::insert(const db_record_t & dr)
 				break;
 
 			case dt_string:
-				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, element_data.b.get_string(element_data.b.get_n_bytes_left())));
+				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, b.get_string(b.get_n_bytes_left())));
 				break;
 
 			case dt_dateTimeSeconds:
-				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, bsoncxx::types::b_date(std::chrono::system_clock::from_time_t(element_data.b.get_net_long()))));
+				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, bsoncxx::types::b_date(std::chrono::system_clock::from_time_t(b.get_net_long()))));
 				break;
 
 			case dt_dateTimeMilliseconds: {
-					std::chrono::milliseconds m(element_data.b.get_net_long_long());
+					std::chrono::milliseconds m(b.get_net_long_long());
 
 					sub_doc.append(bsoncxx::builder::basic::kvp(key_name, bsoncxx::types::b_date(m)));
 				}
@@ -150,7 +155,7 @@ bool db_mongodb::insert(const db_record_t & dr)
 
 			case dt_dateTimeMicroseconds:
 			case dt_dateTimeNanoseconds:
-				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, int64_t(element_data.b.get_net_long_long())));
+				sub_doc.append(bsoncxx::builder::basic::kvp(key_name, int64_t(b.get_net_long_long())));
 				break;
 
 //			case dt_basicList:  TODO
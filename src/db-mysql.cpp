@@ -3,28 +3,97 @@
 #if JANSSON_FOUND != 1
 #error libjansson is required for mariadb
 #endif
+#include <algorithm>
+#include <charconv>
 #include <jansson.h>
 #include <map>
 #include <set>
+#include <string.h>
+#include <mariadb/errmsg.h>
 #include <mariadb/mysql.h>
 
 #include "db-mysql.h"
 #include "error.h"
 #include "ipfix.h"
 #include "logging.h"
+#include "value-format.h"
 
 
-db_mysql::db_mysql(const std::string & host, const std::string & user, const std::string & password, const std::string & database, const db_field_mappings_t & field_mappings) : db_sql(field_mappings)
+db_mysql::db_mysql(const std::string & host, const std::string & user, const std::string & password, const std::string & database, const db_field_mappings_t & field_mappings, const db_sql_batching_t & batching, const bool bulk_insert, const int load_data_rows) :
+	db_sql(field_mappings, batching),
+	load_data_rows(load_data_rows)
 {
 	handle = mysql_init(nullptr);
 	if (!handle)
 		error_exit(false, "db_mysql: failed to initialize MySQL library");
 
+	if (load_data_rows > 0) {
+		unsigned int on = 1;
+
+		mysql_options(handle, MYSQL_OPT_LOCAL_INFILE, &on);
+		mysql_set_local_infile_handler(handle, infile_init, infile_read, infile_end, infile_error, this);
+	}
+
         if (mysql_real_connect(handle, host.c_str(), user.c_str(), password.c_str(), database.c_str(), 0, nullptr, 0) == 0)
 		error_exit(false, "db_mysql: failed to connect to MySQL database, season: %s", mysql_error(handle));
 
 	timestamp_type = "DATETIME";
 	json_type      = "JSON";
+
+	// array binding (STMT_ATTR_ARRAY_SIZE) is in MariaDB 10.2.6 and later
+	const char *server_info = mysql_get_server_info(handle);
+
+	bulk = bulk_insert && strstr(server_info, "MariaDB") && mysql_get_server_version(handle) >= 100206;
+
+	dolog(ll_info, "db_mysql: server \"%s\", rows are written with %s", server_info, bulk ? "array binding" : "multi-row INSERTs");
+
+	if (bulk) {
+		bulk_columns.resize(columns.size());
+
+		for(size_t i=0; i<columns.size(); i++) {
+			bulk_column_t & c = bulk_columns[i];
+
+			c.type        = MYSQL_TYPE_STRING;
+			c.is_unsigned = false;
+
+			if (columns[i].is_json)
+				continue;
+
+			switch(columns[i].dt) {
+				case dt_unsigned8:
+				case dt_unsigned16:
+				case dt_unsigned32:
+				case dt_unsigned64:
+				case dt_dateTimeSeconds:
+				case dt_dateTimeMilliseconds:
+				case dt_dateTimeMicroseconds:
+				case dt_dateTimeNanoseconds:
+					c.type        = MYSQL_TYPE_LONGLONG;
+					c.is_unsigned = true;
+					break;
+
+				case dt_signed8:
+				case dt_signed16:
+				case dt_signed32:
+				case dt_signed64:
+				case dt_boolean:
+					c.type        = MYSQL_TYPE_LONGLONG;
+					break;
+
+				case dt_float32:
+				case dt_float64:
+					c.type        = MYSQL_TYPE_DOUBLE;
+					break;
+
+				case dt_octetArray:
+					c.type        = MYSQL_TYPE_BLOB;
+					break;
+
+				default:  // as text
+					break;
+			}
+		}
+	}
 }
 
 std::string db_mysql::escape_string(const std::string & in)
@@ -45,10 +114,16 @@ std::string db_mysql::escape_string(const std::string & in)
 	return out;
 }
 
+std::string db_mysql::binary_literal(const std::string & hex)
+{
+	return "X'" + hex + "'";
+}
+
 bool db_mysql::execute_query(const std::string & query)
 {
 	if (mysql_query(handle, query.c_str())) {
-		dolog(ll_error, "db_mysql::execute_query: query \"%s\" failed, reason: %s", query.c_str(), mysql_error(handle));
+		// a multi-row INSERT can be megabytes
+		dolog(ll_error, "db_mysql::execute_query: query \"%.256s\" failed, reason: %s", query.c_str(), mysql_error(handle));
 
 		return false;
 	}
@@ -110,7 +185,292 @@ std::string db_mysql::data_type_to_db_type(const data_type_t dt)
 	error_exit(false, "db_mysql::data_type_to_db_type: data-type %d is not supported (yet)", dt);
 }
 
+size_t db_mysql::queue_row(const std::vector<db_sql_value_t> & values)
+{
+	if (!bulk)
+		return db_sql::queue_row(values);
+
+	size_t bytes = 0;
+
+	// missing values and values that cannot be converted become 0
+	for(size_t i=0; i<values.size(); i++) {
+		const db_sql_value_t & v = values[i];
+		bulk_column_t        & c = bulk_columns[i];
+
+		if (c.type == MYSQL_TYPE_LONGLONG) {
+			int64_t number = 0;
+
+			if (v.value && v.dt == dt_boolean)
+				number = v.len == 1 && v.value[0] == 1;
+			else if (v.value)
+				get_integer_value(v.dt, v.value, v.len, &number);
+
+			c.integers.push_back(number);
+
+			bytes += sizeof(long long);
+		}
+		else if (c.type == MYSQL_TYPE_DOUBLE) {
+			double number = 0.;
+
+			if (v.value)
+				get_float_value(v.dt, v.value, v.len, &number);
+
+			c.doubles.push_back(number);
+
+			bytes += sizeof(double);
+		}
+		else {
+			size_t old_size = c.bytes.size();
+
+			if (v.value == nullptr)
+				c.bytes += v.text;
+			else if (c.type == MYSQL_TYPE_BLOB)
+				c.bytes.append(reinterpret_cast<const char *>(v.value), v.len);
+			else if (append_value(v.dt, v.value, v.len, &c.bytes) == false)
+				c.bytes += "0";
+
+			c.offsets.push_back(old_size);
+			c.lengths.push_back(c.bytes.size() - old_size);
+
+			bytes += c.lengths.back();
+		}
+	}
+
+	bulk_rows++;
+
+	return bytes;
+}
+
+bool db_mysql::write_rows()
+{
+	if (!bulk)
+		return db_sql::write_rows();
+
+	bool ok = false;
+
+	if (load_data_rows > 0 && bulk_rows >= unsigned(load_data_rows))
+		ok = write_load_data();
+	else
+		ok = write_bulk();
+
+	return ok && commit();
+}
+
+void db_mysql::clear_rows()
+{
+	if (!bulk) {
+		db_sql::clear_rows();
+
+		return;
+	}
+
+	// keeping their capacity
+	for(auto & c : bulk_columns) {
+		c.integers.clear();
+		c.doubles .clear();
+		c.bytes   .clear();
+		c.offsets .clear();
+		c.lengths .clear();
+	}
+
+	bulk_rows = 0;
+}
+
+bool db_mysql::prepare_bulk()
+{
+	if (stmt)
+		return true;
+
+	std::string query  = "INSERT INTO records(ts";
+	std::string values = "NOW()";
+
+	for(auto & column : columns) {
+		query  += ", " + column.name;
+		values += ", ?";
+	}
+
+	query += ") VALUES(" + values + ")";
+
+	stmt = mysql_stmt_init(handle);
+	if (!stmt) {
+		dolog(ll_error, "db_mysql::prepare_bulk: mysql_stmt_init failed: %s", mysql_error(handle));
+
+		return false;
+	}
+
+	if (mysql_stmt_prepare(stmt, query.c_str(), query.size())) {
+		dolog(ll_error, "db_mysql::prepare_bulk: cannot prepare \"%s\": %s", query.c_str(), mysql_stmt_error(stmt));
+
+		mysql_stmt_close(stmt);
+		stmt = nullptr;
+
+		return false;
+	}
+
+	return true;
+}
+
+// all rows with one execution: every bind is an array of bulk_rows values
+bool db_mysql::write_bulk()
+{
+	if (prepare_bulk() == false)
+		return false;
+
+	binds.assign(bulk_columns.size(), MYSQL_BIND { });
+
+	for(size_t i=0; i<bulk_columns.size(); i++) {
+		bulk_column_t & c = bulk_columns[i];
+		MYSQL_BIND    & b = binds[i];
+
+		b.buffer_type = c.type;
+		b.is_unsigned = c.is_unsigned;
+
+		if (c.type == MYSQL_TYPE_LONGLONG)
+			b.buffer = c.integers.data();
+		else if (c.type == MYSQL_TYPE_DOUBLE)
+			b.buffer = c.doubles.data();
+		else {
+			// 'bytes' no longer grows
+			c.pointers.resize(c.offsets.size());
+
+			for(size_t j=0; j<c.offsets.size(); j++)
+				c.pointers[j] = c.bytes.data() + c.offsets[j];
+
+			b.buffer = c.pointers.data();
+			b.length = c.lengths.data();
+		}
+	}
+
+	unsigned int array_size = bulk_rows;
+
+	if (mysql_stmt_attr_set(stmt, STMT_ATTR_ARRAY_SIZE, &array_size) || mysql_stmt_bind_param(stmt, binds.data()) || mysql_stmt_execute(stmt)) {
+		dolog(ll_error, "db_mysql::write_bulk: inserting %u row(s) failed: %s", bulk_rows, mysql_stmt_error(stmt));
+
+		// prepared again for the next batch
+		mysql_stmt_close(stmt);
+		stmt = nullptr;
+
+		return false;
+	}
+
+	return true;
+}
+
+// the rows as tab separated lines, streamed by infile_read()
+bool db_mysql::write_load_data()
+{
+	std::string query = "LOAD DATA LOCAL INFILE 'ipfixer-batch' INTO TABLE records (";
+
+	for(size_t i=0; i<columns.size(); i++) {
+		if (i)
+			query += ", ";
+
+		query += columns[i].name;
+	}
+
+	query += ") SET ts = NOW()";
+
+	infile_row    = 0;
+	infile_offset = 0;
+	infile_line.clear();
+
+	return execute_query(query);
+}
+
+void db_mysql::make_infile_line(const unsigned int row_nr)
+{
+	infile_line.clear();
+
+	for(size_t i=0; i<bulk_columns.size(); i++) {
+		const bulk_column_t & c = bulk_columns[i];
+
+		if (i)
+			infile_line += '\t';
+
+		char  temp[32];
+		char *end = temp;
+
+		if (c.type == MYSQL_TYPE_LONGLONG) {
+			if (c.is_unsigned)
+				end = std::to_chars(temp, temp + sizeof temp, (unsigned long long)c.integers[row_nr]).ptr;
+			else
+				end = std::to_chars(temp, temp + sizeof temp, c.integers[row_nr]).ptr;
+		}
+		else if (c.type == MYSQL_TYPE_DOUBLE) {
+			end = std::to_chars(temp, temp + sizeof temp, c.doubles[row_nr]).ptr;
+		}
+		else {
+			// the default ESCAPED BY '\\'
+			const char *p = c.bytes.data() + c.offsets[row_nr];
+
+			for(unsigned long j=0; j<c.lengths[row_nr]; j++) {
+				if (p[j] == '\\')
+					infile_line += "\\\\";
+				else if (p[j] == '\t')
+					infile_line += "\\t";
+				else if (p[j] == '\n')
+					infile_line += "\\n";
+				else if (p[j] == 0x00)
+					infile_line += "\\0";
+				else
+					infile_line += p[j];
+			}
+		}
+
+		infile_line.append(temp, end - temp);
+	}
+
+	infile_line += '\n';
+}
+
+int db_mysql::infile_init(void **ptr, const char *filename, void *userdata)
+{
+	*ptr = userdata;
+
+	return 0;
+}
+
+int db_mysql::infile_read(void *ptr, char *buf, unsigned int buf_len)
+{
+	db_mysql     *me = reinterpret_cast<db_mysql *>(ptr);
+	unsigned int  n  = 0;
+
+	while(n < buf_len) {
+		if (me->infile_offset == me->infile_line.size()) {
+			if (me->infile_row == me->bulk_rows)
+				break;
+
+			me->make_infile_line(me->infile_row++);
+			me->infile_offset = 0;
+		}
+
+		size_t chunk = std::min(size_t(buf_len - n), me->infile_line.size() - me->infile_offset);
+
+		memcpy(buf + n, me->infile_line.data() + me->infile_offset, chunk);
+
+		n                 += chunk;
+		me->infile_offset += chunk;
+	}
+
+	return n;
+}
+
+void db_mysql::infile_end(void *ptr)
+{
+}
+
+int db_mysql::infile_error(void *ptr, char *error_msg, unsigned int error_msg_len)
+{
+	snprintf(error_msg, error_msg_len, "db_mysql: cannot stream batch");
+
+	return CR_UNKNOWN_ERROR;
+}
+
 db_mysql::~db_mysql()
 {
+	stop_flushing();
+
+	if (stmt)
+		mysql_stmt_close(stmt);
 }
 #endif
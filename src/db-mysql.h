@@ -1,6 +1,8 @@
 #include "config.h"
 #if MARIADB_FOUND == 1
 #include <mariadb/mysql.h>
+#include <string>
+#include <vector>
 
 #include "db-sql.h"
 
@@ -14,15 +16,58 @@ private:
 	const std::string         database;
 	MYSQL                    *handle;
 
+	// bulk mode: the rows are kept per column (in native form) and sent with
+	// one execution of a prepared statement (MariaDB array binding) or, for
+	// large batches, with LOAD DATA LOCAL INFILE
+	typedef struct
+	{
+		enum_field_types           type;
+		bool                       is_unsigned;
+		std::vector<long long>     integers;
+		std::vector<double>        doubles;
+		// strings and blobs, one after the other
+		std::string                bytes;
+		std::vector<size_t>        offsets;
+		std::vector<char *>        pointers;
+		std::vector<unsigned long> lengths;
+	} bulk_column_t;
+
+	bool                       bulk           { false };
+	const int                  load_data_rows;
+	MYSQL_STMT                *stmt           { nullptr };
+	std::vector<bulk_column_t> bulk_columns;
+	std::vector<MYSQL_BIND>    binds;
+	unsigned int               bulk_rows      { 0 };
+
+	// state of LOAD DATA LOCAL INFILE: row that is being sent
+	unsigned int               infile_row     { 0 };
+	std::string                infile_line;
+	size_t                     infile_offset  { 0 };
+
+	static int  infile_init (void **ptr, const char *filename, void *userdata);
+	static int  infile_read (void *ptr, char *buf, unsigned int buf_len);
+	static void infile_end  (void *ptr);
+	static int  infile_error(void *ptr, char *error_msg, unsigned int error_msg_len);
+
+	void        make_infile_line(const unsigned int row_nr);
+	bool        prepare_bulk();
+	bool        write_bulk();
+	bool        write_load_data();
+
 protected:
 	std::string data_type_to_db_type(const data_type_t dt) override;
 
 	std::string escape_string(const std::string & in) override;
+	std::string binary_literal(const std::string & hex) override;
 	bool        execute_query(const std::string & q) override;
 	bool        commit() override;
 
+	size_t      queue_row(const std::vector<db_sql_value_t> & values) override;
+	bool        write_rows() override;
+	void        clear_rows() override;
+
 public:
-	db_mysql(const std::string & host, const std::string & user, const std::string & password, const std::string & database, const db_field_mappings_t & field_mappings);
+	db_mysql(const std::string & host, const std::string & user, const std::string & password, const std::string & database, const db_field_mappings_t & field_mappings, const db_sql_batching_t & batching, const bool bulk_insert, const int load_data_rows);
 	virtual ~db_mysql();
 };
 #endif
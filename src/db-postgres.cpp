@@ -3,8 +3,14 @@
 #if JANSSON_FOUND != 1
 #error libjansson is required for postgresql
 #endif
+#include <endian.h>
 #include <jansson.h>
+#include <libpq-fe.h>
+#include <poll.h>
 #include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <pqxx/pqxx>
 
 #include "db-postgres.h"
@@ -12,18 +18,77 @@
 #include "ipfix.h"
 #include "logging.h"
 #include "str.h"
+#include "time.h"
+#include "value-format.h"
 
 
-db_postgres::db_postgres(const std::string & connection_info, const db_field_mappings_t & field_mappings) : db_sql(field_mappings)
+// tuples are sent to the server in chunks of about this size
+constexpr size_t copy_chunk_size = 64 * 1024;
+
+// 2000-01-01 00:00:00, the epoch of the binary timestamp
+constexpr int64_t postgres_epoch_us = 946684800ll * 1000000;
+
+// pipeline mode: more unanswered syncs than this and the writer waits
+constexpr int pipeline_max_syncs = 16;
+
+
+db_postgres::db_postgres(const std::string & connection_info, const db_field_mappings_t & field_mappings, const db_sql_batching_t & batching, const postgres_write_mode_t write_mode) :
+	db_sql(field_mappings, batching),
+	write_mode(write_mode)
 {
 	connection = new pqxx::connection(connection_info);
 
 	timestamp_type = "TIMESTAMP";
 	json_type      = "JSONB";
+
+	if (write_mode == pwm_insert)
+		return;
+
+	pq_conn = PQconnectdb(connection_info.c_str());
+
+	if (PQstatus(pq_conn) != CONNECTION_OK)
+		error_exit(false, "db_postgres: failed to connect to PostgreSQL database, reason: %s", PQerrorMessage(pq_conn));
+
+	if (write_mode == pwm_copy) {
+		pq_query = "COPY records(ts";
+
+		for(auto & column : columns)
+			pq_query += ", " + column.name;
+
+		pq_query += ") FROM STDIN (FORMAT binary)";
+
+		update_ts_offset();
+	}
+	else {
+		std::string values = "NOW()";
+
+		pq_query = "INSERT INTO records(ts";
+
+		for(size_t i=0; i<columns.size(); i++) {
+			pq_query += ", " + columns[i].name;
+			values   += ", $" + std::to_string(i + 1);
+		}
+
+		pq_query += ") VALUES(" + values + ")";
+
+		param_offsets.resize(columns.size());
+		param_values .resize(columns.size());
+		param_lengths.resize(columns.size());
+		param_formats.assign(columns.size(), 1);  // binary
+	}
 }
 
 db_postgres::~db_postgres()
 {
+	stop_flushing();
+
+	// results of the last sync
+	if (pipelining)
+		reap_pipeline(0);
+
+	if (pq_conn)
+		PQfinish(pq_conn);
+
 	delete connection;
 }
 
@@ -32,12 +97,17 @@ std::string db_postgres::escape_string(const std::string & in)
 	return connection->esc(in);
 }
 
+std::string db_postgres::binary_literal(const std::string & hex)
+{
+	return "decode('" + hex + "', 'hex')";
+}
+
 bool db_postgres::execute_query(const std::string & query)
 {
 	pqxx::work work { *connection };
 	work.exec(query);
 
-	work.commit();  // TODO: move to 'commit'-method
+	work.commit();  // one transaction per (multi-row) query
 
 	return true;
 }
@@ -47,10 +117,478 @@ bool db_postgres::commit()
 	return true;
 }
 
+static void put_int16(std::string *const out, const uint16_t v)
+{
+	uint16_t temp = htobe16(v);
+
+	out->append(reinterpret_cast<const char *>(&temp), 2);
+}
+
+static void put_int32(std::string *const out, const uint32_t v)
+{
+	uint32_t temp = htobe32(v);
+
+	out->append(reinterpret_cast<const char *>(&temp), 4);
+}
+
+static void put_int64(std::string *const out, const uint64_t v)
+{
+	uint64_t temp = htobe64(v);
+
+	out->append(reinterpret_cast<const char *>(&temp), 8);
+}
+
+// length and value of a field of a COPY tuple (or a parameter), in the binary
+// format of the column type (see data_type_to_db_type()); missing values
+// become 0
+void db_postgres::put_copy_value(const db_sql_column_t & column, const db_sql_value_t & v, std::string *const out)
+{
+	if (column.is_json) {
+		// jsonb: version 1, followed by the text
+		put_int32(out, v.text.size() + 1);
+		*out += char(1);
+		*out += v.text;
+
+		return;
+	}
+
+	int64_t integer = 0;
+
+	switch(column.dt) {
+		case dt_unsigned8:
+		case dt_signed8:
+		case dt_signed16:  // SMALLINT
+			if (v.value)
+				get_integer_value(v.dt, v.value, v.len, &integer);
+
+			put_int32(out, 2);
+			put_int16(out, integer);
+			break;
+
+		case dt_unsigned16:
+		case dt_signed32:
+		case dt_dateTimeSeconds:  // INT
+			if (v.value)
+				get_integer_value(v.dt, v.value, v.len, &integer);
+
+			put_int32(out, 4);
+			put_int32(out, integer);
+			break;
+
+		case dt_unsigned32:
+		case dt_unsigned64:  // BIGINT: above 2^63 - 1 it wraps
+		case dt_signed64:
+		case dt_dateTimeMilliseconds:
+		case dt_dateTimeMicroseconds:
+		case dt_dateTimeNanoseconds:
+			if (v.value)
+				get_integer_value(v.dt, v.value, v.len, &integer);
+
+			put_int32(out, 8);
+			put_int64(out, integer);
+			break;
+
+		case dt_float32:
+		case dt_float64: {  // double precision
+				double   number = 0.;
+				uint64_t bits   = 0;
+
+				if (v.value)
+					get_float_value(v.dt, v.value, v.len, &number);
+
+				memcpy(&bits, &number, 8);
+
+				put_int32(out, 8);
+				put_int64(out, bits);
+			}
+			break;
+
+		case dt_boolean:
+			put_int32(out, 1);
+			*out += char(v.value && v.len == 1 && v.value[0] == 1);
+			break;
+
+		case dt_ipv4Address:
+		case dt_ipv6Address: {
+				// inet: family (PGSQL_AF_INET(6)), bits, is_cidr, address length
+				static const uint8_t zero[4] { };
+
+				bool           is_ipv6 = v.value && v.len == 16;
+				const uint8_t *address = is_ipv6 || (v.value && v.len == 4) ? v.value : zero;
+				int            len     = is_ipv6 ? 16 : 4;
+
+				put_int32(out, 4 + len);
+				*out += char(is_ipv6 ? 3 : 2);
+				*out += char(len * 8);
+				*out += char(0);
+				*out += char(len);
+				out->append(reinterpret_cast<const char *>(address), len);
+			}
+			break;
+
+		default: {  // bytea (as is) and text
+				size_t length_offset = out->size();
+
+				put_int32(out, 0);
+
+				if (v.value == nullptr)
+					*out += v.text;
+				else if (column.dt == dt_octetArray)
+					out->append(reinterpret_cast<const char *>(v.value), v.len);
+				else if (append_value(v.dt, v.value, v.len, out) == false)
+					*out += "0";
+
+				uint32_t len = htobe32(out->size() - length_offset - 4);
+				memcpy(&(*out)[length_offset], &len, 4);
+			}
+			break;
+	}
+}
+
+size_t db_postgres::queue_row(const std::vector<db_sql_value_t> & values)
+{
+	if (write_mode == pwm_insert)
+		return db_sql::queue_row(values);
+
+	if (write_mode == pwm_pipeline)
+		return send_pipeline_row(values) ? param_buffer.size() : 0;
+
+	size_t old_size = copy_buffer.size();
+
+	put_int16(&copy_buffer, values.size() + 1);
+
+	// ts: microseconds since the postgres epoch, local time of the session
+	uint64_t now_us = get_us();
+
+	// (not while a COPY is in progress on the connection)
+	if (time_t(now_us / 3600000000ull) != ts_hour && copying == false)
+		update_ts_offset();
+
+	put_int32(&copy_buffer, 8);
+	put_int64(&copy_buffer, int64_t(now_us) + ts_offset * 1000000ll - postgres_epoch_us);
+
+	for(size_t i=0; i<values.size(); i++)
+		put_copy_value(columns[i], values[i], &copy_buffer);
+
+	size_t n = copy_buffer.size() - old_size;
+
+	// stream while the batch fills up
+	if (copy_buffer.size() >= copy_chunk_size)
+		send_copy_data();
+
+	return n;
+}
+
+void db_postgres::update_ts_offset()
+{
+	ts_hour = time(nullptr) / 3600;
+
+	PGresult *result = PQexec(pq_conn, "SELECT EXTRACT(TIMEZONE FROM now())");
+
+	if (PQresultStatus(result) == PGRES_TUPLES_OK && PQntuples(result) == 1)
+		ts_offset = strtol(PQgetvalue(result, 0, 0), nullptr, 10);
+	else
+		dolog(ll_warning, "db_postgres::update_ts_offset: cannot retrieve the time zone of the session (%s), using an offset of %ld seconds", PQresultErrorMessage(result), ts_offset);
+
+	PQclear(result);
+}
+
+bool db_postgres::start_copy()
+{
+	if (PQstatus(pq_conn) != CONNECTION_OK) {
+		dolog(ll_warning, "db_postgres::start_copy: connection lost (%s), reconnecting", PQerrorMessage(pq_conn));
+
+		PQreset(pq_conn);
+	}
+
+	PGresult *result = PQexec(pq_conn, pq_query.c_str());
+	bool      ok     = PQresultStatus(result) == PGRES_COPY_IN;
+
+	if (!ok)
+		dolog(ll_error, "db_postgres::start_copy: \"%s\" failed: %s", pq_query.c_str(), PQresultErrorMessage(result));
+
+	PQclear(result);
+
+	if (!ok)
+		return false;
+
+	// signature, flags, header extension length
+	static const char header[] = "PGCOPY\n\377\r\n\0\0\0\0\0\0\0\0\0";
+
+	if (PQputCopyData(pq_conn, header, sizeof(header) - 1) != 1) {
+		dolog(ll_error, "db_postgres::start_copy: cannot send header: %s", PQerrorMessage(pq_conn));
+
+		end_copy(false);
+
+		return false;
+	}
+
+	copying = true;
+
+	return true;
+}
+
+// what is in copy_buffer; after a failure the rest of the batch is dropped
+bool db_postgres::send_copy_data()
+{
+	if (copy_failed)
+		return false;
+
+	if (copy_buffer.empty())
+		return true;
+
+	if (copying == false && start_copy() == false)
+		copy_failed = true;
+	else if (PQputCopyData(pq_conn, copy_buffer.data(), copy_buffer.size()) != 1) {
+		dolog(ll_error, "db_postgres::send_copy_data: %s", PQerrorMessage(pq_conn));
+
+		copy_failed = true;
+	}
+
+	copy_buffer.clear();
+
+	return !copy_failed;
+}
+
+// commits (or aborts) the COPY
+bool db_postgres::end_copy(const bool ok)
+{
+	bool rc = ok;
+
+	if (ok) {
+		// trailer
+		const char trailer[] = { char(0xff), char(0xff) };
+
+		if (PQputCopyData(pq_conn, trailer, 2) != 1)
+			rc = false;
+	}
+
+	if (PQputCopyEnd(pq_conn, rc ? nullptr : "ipfixer: batch aborted") != 1)
+		rc = false;
+
+	while(PGresult *result = PQgetResult(pq_conn)) {
+		if (PQresultStatus(result) != PGRES_COMMAND_OK) {
+			if (ok)
+				dolog(ll_error, "db_postgres::end_copy: COPY failed: %s", PQresultErrorMessage(result));
+
+			rc = false;
+		}
+
+		PQclear(result);
+	}
+
+	copying = false;
+
+	return rc;
+}
+
+bool db_postgres::start_pipeline()
+{
+#ifdef LIBPQ_HAS_PIPELINING
+	if (PQstatus(pq_conn) != CONNECTION_OK) {
+		dolog(ll_warning, "db_postgres::start_pipeline: connection lost (%s), reconnecting", PQerrorMessage(pq_conn));
+
+		PQreset(pq_conn);
+	}
+
+	// else writing can block while the server waits for its results to be read
+	if (PQsetnonblocking(pq_conn, 1) != 0 || (PQpipelineStatus(pq_conn) == PQ_PIPELINE_OFF && PQenterPipelineMode(pq_conn) != 1)) {
+		dolog(ll_error, "db_postgres::start_pipeline: cannot enter pipeline mode: %s", PQerrorMessage(pq_conn));
+
+		return false;
+	}
+
+	if (PQsendPrepare(pq_conn, "ipfixer_insert", pq_query.c_str(), 0, nullptr) != 1) {
+		dolog(ll_error, "db_postgres::start_pipeline: cannot prepare \"%s\": %s", pq_query.c_str(), PQerrorMessage(pq_conn));
+
+		return false;
+	}
+
+	pipelining       = true;
+	pipeline_queries = 1;
+	pipeline_syncs   = 0;
+	pipeline_rows    = 0;
+	pipeline_failed  = false;
+
+	pipeline_synced_rows.clear();
+
+	return true;
+#else
+	dolog(ll_error, "db_postgres::start_pipeline: libpq was built without pipeline mode (14 or newer is required)");
+
+	return false;
+#endif
+}
+
+// after a connection problem; what was in flight is lost
+void db_postgres::reset_pipeline()
+{
+	int n_lost = pipeline_rows;
+
+	for(int n : pipeline_synced_rows)
+		n_lost += n;
+
+	dolog(ll_error, "db_postgres::reset_pipeline: %s, %d row(s) in flight lost", PQerrorMessage(pq_conn), n_lost);
+
+	pipelining = false;
+
+	PQreset(pq_conn);
+}
+
+bool db_postgres::send_pipeline_row(const std::vector<db_sql_value_t> & values)
+{
+	if (pipelining == false && start_pipeline() == false)
+		return false;
+
+	param_buffer.clear();
+
+	for(size_t i=0; i<values.size(); i++) {
+		param_offsets[i] = param_buffer.size();
+
+		put_copy_value(columns[i], values[i], &param_buffer);
+	}
+
+	// skip the lengths that put_copy_value() puts in front
+	for(size_t i=0; i<values.size(); i++) {
+		size_t next = i + 1 < values.size() ? param_offsets[i + 1] : param_buffer.size();
+
+		param_values [i] = param_buffer.data() + param_offsets[i] + 4;
+		param_lengths[i] = next - param_offsets[i] - 4;
+	}
+
+	if (PQsendQueryPrepared(pq_conn, "ipfixer_insert", values.size(), param_values.data(), param_lengths.data(), param_formats.data(), 0) != 1) {
+		reset_pipeline();
+
+		return false;
+	}
+
+	pipeline_queries++;
+	pipeline_rows++;
+
+	// sends what it can and handles the results that are there
+	return reap_pipeline(pipeline_max_syncs);
+}
+
+// handles the results that arrived; waits while more than 'max_syncs' syncs
+// are unanswered
+bool db_postgres::reap_pipeline(const int max_syncs)
+{
+#ifdef LIBPQ_HAS_PIPELINING
+	for(;;) {
+		int flush_rc = PQflush(pq_conn);
+
+		if (flush_rc == -1 || PQconsumeInput(pq_conn) == 0) {
+			reset_pipeline();
+
+			return false;
+		}
+
+		while((pipeline_queries > 0 || pipeline_syncs > 0) && PQisBusy(pq_conn) == 0) {
+			PGresult *result = PQgetResult(pq_conn);
+
+			// end of the results of a query
+			if (result == nullptr) {
+				pipeline_queries--;
+
+				continue;
+			}
+
+			ExecStatusType status = PQresultStatus(result);
+
+			if (status == PGRES_PIPELINE_SYNC) {
+				pipeline_syncs--;
+
+				int n_rows = pipeline_synced_rows.empty() ? 0 : pipeline_synced_rows.front();
+
+				if (pipeline_synced_rows.empty() == false)
+					pipeline_synced_rows.pop_front();
+
+				// the rows before the failure were rolled back as well
+				if (pipeline_failed) {
+					dolog(ll_warning, "db_postgres::reap_pipeline: %d row(s) not inserted", n_rows);
+
+					pipeline_failed = false;
+				}
+			}
+			else if (status == PGRES_PIPELINE_ABORTED) {
+				pipeline_failed = true;
+			}
+			else if (status != PGRES_COMMAND_OK) {
+				dolog(ll_error, "db_postgres::reap_pipeline: insert failed: %s", PQresultErrorMessage(result));
+
+				pipeline_failed = true;
+			}
+
+			PQclear(result);
+		}
+
+		// until everything is sent (while reading results, see above)
+		if (pipeline_syncs <= max_syncs && flush_rc == 0)
+			return true;
+
+		pollfd fd { PQsocket(pq_conn), short(POLLIN | (flush_rc == 1 ? POLLOUT : 0)), 0 };
+
+		if (poll(&fd, 1, 1000) == 0)
+			dolog(ll_debug, "db_postgres::reap_pipeline: waiting for %d sync(s)", pipeline_syncs);
+	}
+#else
+	return false;
+#endif
+}
+
+bool db_postgres::write_rows()
+{
+	if (write_mode == pwm_insert)
+		return db_sql::write_rows();
+
+	if (write_mode == pwm_pipeline) {
+#ifdef LIBPQ_HAS_PIPELINING
+		// the rows since the previous one are committed together
+		if (pipelining == false)
+			return false;
+
+		if (PQpipelineSync(pq_conn) != 1) {
+			reset_pipeline();
+
+			return false;
+		}
+
+		pipeline_syncs++;
+
+		pipeline_synced_rows.push_back(pipeline_rows);
+		pipeline_rows = 0;
+
+		return reap_pipeline(pipeline_max_syncs);
+#else
+		return false;
+#endif
+	}
+
+	bool ok = send_copy_data();
+
+	if (copying)
+		ok = end_copy(ok) && ok;
+
+	return ok;
+}
+
+void db_postgres::clear_rows()
+{
+	if (write_mode == pwm_insert) {
+		db_sql::clear_rows();
+
+		return;
+	}
+
+	// pwm_pipeline: nothing is kept
+	copy_buffer.clear();
+	copy_failed = false;
+}
+
 std::string db_postgres::data_type_to_db_type(const data_type_t dt) 
 {
 	if (dt == dt_octetArray)
-		return "BLOB";
+		return "BYTEA";
 	else if (dt == dt_unsigned8)
 		return "SMALLINT";
 	else if (dt == dt_unsigned16)
@@ -70,7 +608,7 @@ std::string db_postgres::data_type_to_db_type(const data_type_t dt)
 	else if (dt == dt_float32)
 		return "FLOAT";
 	else if (dt == dt_float64)
-		return "DOUBLE";
+		return "DOUBLE PRECISION";
 	else if (dt == dt_boolean)
 		return "BOOLEAN";
 	else if (dt == dt_macAddress)
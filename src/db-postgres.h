@@ -1,10 +1,21 @@
 #include "config.h"
 #if POSTGRES_FOUND == 1
+#include <libpq-fe.h>
+#include <deque>
+#include <string>
+#include <time.h>
+#include <vector>
 #include <pqxx/pqxx>
 
 #include "db-sql.h"
 
 
+typedef enum {
+	pwm_insert,  // multi-row INSERT (text)
+	pwm_copy,    // COPY ... FROM STDIN (FORMAT binary)
+	pwm_pipeline // prepared INSERT per row, libpq pipeline mode
+} postgres_write_mode_t;
+
 class db_postgres : public db_sql
 {
 private:
@@ -14,15 +25,69 @@ private:
 	const std::string  database;
 	pqxx::connection  *connection { nullptr };
 
+	const postgres_write_mode_t write_mode;
+
+	// pwm_copy and pwm_pipeline
+	PGconn            *pq_conn     { nullptr };
+	// the COPY or the INSERT that is prepared
+	std::string        pq_query;
+
+	// pwm_copy: the COPY is started with the first chunk of a batch and
+	// ended (committed) when db_sql flushes the batch
+	bool               copying     { false };
+	bool               copy_failed { false };
+	// tuples not yet sent
+	std::string        copy_buffer;
+
+	// for the ts column: NOW() for a TIMESTAMP is the local time of the
+	// TimeZone of the session, so its UTC offset (in seconds) is asked once
+	// an hour (daylight saving time)
+	time_t             ts_hour     { -1 };
+	long               ts_offset   { 0 };
+
+	// pwm_pipeline: every row is sent when it is queued, a flush of db_sql
+	// is a sync point (and commit); results are handled when they arrive
+	bool               pipelining       { false };
+	// sent, results not handled yet
+	int                pipeline_queries { 0 };
+	int                pipeline_syncs   { 0 };
+	// rows sent since the last sync, and per sync that was not answered yet;
+	// a failure rolls back all the rows of its sync (implicit transaction)
+	int                pipeline_rows    { 0 };
+	std::deque<int>    pipeline_synced_rows;
+	bool               pipeline_failed  { false };
+	// parameters of a row (binary, as in a COPY tuple)
+	std::string        param_buffer;
+	std::vector<size_t>       param_offsets;
+	std::vector<const char *> param_values;
+	std::vector<int>          param_lengths;
+	std::vector<int>          param_formats;
+
+	void        put_copy_value(const db_sql_column_t & column, const db_sql_value_t & v, std::string *const out);
+	void        update_ts_offset();
+	bool        start_copy();
+	bool        send_copy_data();
+	bool        end_copy(const bool ok);
+
+	bool        start_pipeline();
+	void        reset_pipeline();
+	bool        send_pipeline_row(const std::vector<db_sql_value_t> & values);
+	bool        reap_pipeline(const int max_syncs);
+
 protected:
 	std::string data_type_to_db_type(const data_type_t dt) override;
 
 	std::string escape_string(const std::string & in) override;
+	std::string binary_literal(const std::string & hex) override;
 	bool        execute_query(const std::string & q) override;
 	bool        commit() override;
 
+	size_t      queue_row(const std::vector<db_sql_value_t> & values) override;
+	bool        write_rows() override;
+	void        clear_rows() override;
+
 public:
-	db_postgres(const std::string & connection_info, const db_field_mappings_t & field_mappings);
+	db_postgres(const std::string & connection_info, const db_field_mappings_t & field_mappings, const db_sql_batching_t & batching, const postgres_write_mode_t write_mode);
 	virtual ~db_postgres();
 };
 #endif
@@ -1,229 +1,448 @@
+#include <chrono>
 #include <jansson.h>
 #include <map>
-#include <set>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <thread>
 
 #include "db-sql.h"
 #include "error.h"
 #include "logging.h"
 #include "ipfix.h"
 #include "str.h"
+#include "time.h"
+#include "value-format.h"
 
 
-db_sql::db_sql(const db_field_mappings_t & field_mappings) : field_mappings(field_mappings)
+db_sql::db_sql(const db_field_mappings_t & field_mappings, const db_sql_batching_t & batching) :
+	batching(batching),
+	field_mappings(field_mappings)
 {
+	// the same for every row: list of fields, making sure they're unique (a
+	// json blob has one field-name!)
+	std::map<std::string, size_t> column_indexes;
+
+	for(auto & mapping : field_mappings.mappings) {
+		auto it = column_indexes.find(mapping.second.target_name);
+
+		if (it == column_indexes.end()) {
+			data_type_t dt = dt_string;
+
+			if (mapping.second.target_is_json == false) {
+				auto data_type = field_lookup.get_data_type(mapping.first);
+
+				if (data_type.has_value() == false)
+					error_exit(false, "db_sql: field with name \"%s\" is not known", mapping.first.c_str());
+
+				dt = data_type.value();
+			}
+
+			it = column_indexes.insert({ mapping.second.target_name, columns.size() }).first;
+
+			columns.push_back({ mapping.second.target_name, mapping.second.target_is_json, dt });
+		}
+
+		mappings.push_back({ mapping.first, mapping.second.field_id, mapping.second.target_is_json, it->second });
+	}
+
+	// any left-over fields can be optionally put in a json blob
+	if (field_mappings.unmapped_fields.empty() == false)
+		columns.push_back({ field_mappings.unmapped_fields, true, dt_string });
+
+	insert_prefix = "INSERT INTO records(ts";
+
+	for(auto & column : columns)
+		insert_prefix += ", " + column.name;
+
+	insert_prefix += ") VALUES";
+
+	row.resize(columns.size());
+	json_values.resize(columns.size());
 }
 
 db_sql::~db_sql()
 {
+	if (flusher)
+		dolog(ll_error, "db_sql::~db_sql: stop_flushing() was not invoked, %d row(s) lost", n_pending);
 }
 
-void db_sql::init_database()
+// with pending_lock held
+bool db_sql::flush_pending()
 {
-	std::string query = "CREATE TABLE IF NOT EXISTS records(ts " + timestamp_type + " NOT NULL";
+	if (n_pending == 0)
+		return true;
 
-	// json-fields must be created once
-	std::set<std::string> json_fields;
+	dolog(ll_debug, "db_sql::flush_pending: inserting %d row(s) (%zu bytes)", n_pending, pending_bytes);
 
-	for(auto & mapping : field_mappings.mappings) {
-		std::string type;
-		bool        add = true;
+	bool ok = false;
+
+	try {
+		ok = write_rows();
+	}
+	catch(const std::string & s) {
+		dolog(ll_warning, "db_sql::flush_pending: problem during insertion of %d row(s): %s", n_pending, s.c_str());
+	}
+	catch(const std::exception & e) {
+		dolog(ll_warning, "db_sql::flush_pending: problem during insertion of %d row(s): %s", n_pending, e.what());
+	}
 
-		if (mapping.second.target_is_json) {
-			type = json_type;
+	if (ok == false) {
+		int n_rows = n_pending;
+		int n_lost = n_rows == 1 ? 1 : retry_rows(n_rows);
 
-			if (json_fields.find(mapping.second.target_name) != json_fields.end())
-				add = false;
-			else
-				json_fields.insert(mapping.second.target_name);
-		}
-		else {
-			auto data_type = field_lookup.get_data_type(mapping.first);
+		if (n_lost)
+			dolog(ll_warning, "db_sql::flush_pending: %d of %d row(s) lost", n_lost, n_rows);
+
+		ok = n_lost == 0;
+	}
+
+	clear_rows();
+	n_pending     = 0;
+	pending_bytes = 0;
+
+	retry_values .clear();
+	retry_offsets.clear();
+	retry_bytes  .clear();
+
+	return ok;
+}
+
+// with pending_lock held; returns the number of rows that could not be
+// written
+int db_sql::retry_rows(const int n_rows)
+{
+	const size_t n_columns = columns.size();
+
+	std::vector<db_sql_value_t> values(n_columns);
+
+	int n_lost = 0;
+
+	for(int r=0; r<n_rows; r++) {
+		for(size_t i=0; i<n_columns; i++) {
+			size_t k = r * n_columns + i;
 
-			if (data_type.has_value() == false)
-				error_exit(false, "db_sql::init_database: field with name \"%s\" is not known", mapping.second.target_name.c_str());
+			values[i] = retry_values[k];
 
-			type = data_type_to_db_type(data_type.value());
+			if (retry_offsets[k] != std::string::npos)
+				values[i].value = reinterpret_cast<const uint8_t *>(&retry_bytes[retry_offsets[k]]);
 		}
 
-		if (add)
-			query += ", " + mapping.second.target_name + " " + type + " NOT NULL";
-	}
+		clear_rows();
+		n_pending = 0;
 
-	if (field_mappings.unmapped_fields.empty() == false)
-		query += ", " + field_mappings.unmapped_fields + " " + json_type + " NOT NULL";
+		bool ok = false;
 
-	query += ")";
+		try {
+			queue_row(values);
+			n_pending = 1;
 
-	execute_query(query);
+			ok = write_rows();
+		}
+		catch(const std::string & s) {
+			dolog(ll_info, "db_sql::retry_rows: problem during insertion of row %d: %s", r, s.c_str());
+		}
+		catch(const std::exception & e) {
+			dolog(ll_info, "db_sql::retry_rows: problem during insertion of row %d: %s", r, e.what());
+		}
+
+		if (ok == false)
+			n_lost++;
+	}
+
+	return n_lost;
 }
 
-// get & erase!
-std::optional<std::string> db_sql::pull_field_from_db_record_t(db_record_t & data, const std::string & key)
+size_t db_sql::queue_row(const std::vector<db_sql_value_t> & values)
 {
-	auto it = data.data.find(key);
+	size_t old_size = pending.size();
 
-	if (it == data.data.end())
-		return { };
+	if (n_pending == 0)
+		pending = insert_prefix;
+	else
+		pending += ",";
 
-	auto value = ipfix::data_to_str(it->second.dt, it->second.len, it->second.b);
+	// every records gets a timestamp (of when the batch is written, so at
+	// most max_delay_ms later)
+	pending += "(NOW()";
 
-	if (value.has_value() == false) {
-		dolog(ll_info, "db_sql::pull_field_from_db_record_t: cannot convert \"%s\" (data-type %d) to string", key.c_str(), it->second.dt);
+	for(size_t i=0; i<values.size(); i++) {
+		const db_sql_value_t & v = values[i];
 
-		return { };
+		if (v.value && v.dt == dt_octetArray && columns[i].is_json == false) {
+			text_buffer.clear();
+
+			if (append_value(v.dt, v.value, v.len, &text_buffer)) {
+				pending += ", " + binary_literal(text_buffer);
+
+				continue;
+			}
+		}
+
+		pending += ", '";
+
+		if (v.value) {
+			text_buffer.clear();
+
+			if (append_value(v.dt, v.value, v.len, &text_buffer) == false)
+				text_buffer = "0";
+
+			pending += escape_string(text_buffer);
+		}
+		else {
+			pending += escape_string(v.text);
+		}
+
+		pending += "'";
 	}
 
-	data.data.erase(it);
+	pending += ")";
 
-	return value.value();
+	return pending.size() - old_size;
 }
 
-bool db_sql::insert(const db_record_t & dr)
+bool db_sql::write_rows()
 {
-	try {
-		bool        fail = false;
-		db_record_t work = dr;
+	return execute_query(pending) && commit();
+}
 
-		std::string query = "INSERT INTO records(ts";
+void db_sql::clear_rows()
+{
+	// keeps its capacity
+	pending.clear();
+}
 
-		std::map<std::string, json_t *> json_values;
+// with pending_lock held
+void db_sql::add_row()
+{
+	if (n_pending == 0)
+		pending_since = get_ms();
 
-		// create list of fields, making sure they're unique (a json blob has one
-		// field-name!)
-		for(auto & mapping : field_mappings.mappings) {
-			if (json_values.find(mapping.second.target_name) == json_values.end()) {
-				query += ", " + mapping.second.target_name;
+	pending_bytes += queue_row(row);
+	n_pending++;
 
-				json_values.insert({ mapping.second.target_name, json_object() });
-			}
+	for(auto & v : row) {
+		retry_values.push_back(v);
+
+		if (v.value) {
+			retry_offsets.push_back(retry_bytes.size());
+			retry_bytes.append(reinterpret_cast<const char *>(v.value), v.len);
+
+			retry_values.back().value = nullptr;
+		}
+		else {
+			retry_offsets.push_back(std::string::npos);
 		}
+	}
 
-		// any left-over fields can be optionally put in a json blob
-		if (field_mappings.unmapped_fields.empty() == false)
-			query += ", " + field_mappings.unmapped_fields;
+	if (n_pending >= batching.max_rows || pending_bytes >= batching.max_bytes)
+		flush_pending();
+	else if (flusher == nullptr && batching.max_delay_ms > 0)
+		flusher = new std::thread([this] { this->run_flusher(); });
+}
 
-		// every records gets a timestamp
-		query += ") VALUES(NOW()";
+void db_sql::run_flusher()
+{
+	std::unique_lock<std::mutex> lck(pending_lock);
 
-		// first collect all json-fields
-		for(auto & mapping : field_mappings.mappings) {
-			if (mapping.second.target_is_json) {
-				// get json object for this field
-				auto it = json_values.find(mapping.second.target_name);
-				if (it == json_values.end()) {
-					dolog(ll_info, "db_sql::insert: json_values no longer has \"%s\"", mapping.second.target_name.c_str());
+	while(stop_flusher == false) {
+		uint64_t wait_ms = batching.max_delay_ms;
 
-					fail = true;
-					break;
-				}
+		if (n_pending) {
+			uint64_t age = get_ms() - pending_since;
 
-				// get ipfix data
-				std::string value;
-				auto temp = pull_field_from_db_record_t(work, mapping.first);
-				if (temp.has_value() == false) {
-					dolog(ll_info, "db_sql::insert: data for \"%s\" missing (json)", mapping.first.c_str());
-					value = "0";
-				}
-				else {
-					value = temp.value();
-				}
+			if (age >= uint64_t(batching.max_delay_ms)) {
+				flush_pending();
 
-				// map IANA name in JSON-object to value
-				json_object_set(it->second, mapping.first.c_str(), json_string(value.c_str()));
+				continue;
 			}
+
+			wait_ms -= age;
 		}
 
-		std::set<std::string> json_fields;
+		flusher_cv.wait_for(lck, std::chrono::milliseconds(wait_ms));
+	}
+}
+
+void db_sql::stop_flushing()
+{
+	std::unique_lock<std::mutex> lck(pending_lock);
+
+	stop_flusher = true;
+
+	if (flusher) {
+		lck.unlock();
+
+		flusher_cv.notify_one();
+
+		flusher->join();
+		delete flusher;
+		flusher = nullptr;
+
+		lck.lock();
+	}
+
+	flush_pending();
+}
+
+void db_sql::init_database()
+{
+	std::string query = "CREATE TABLE IF NOT EXISTS records(ts " + timestamp_type + " NOT NULL";
+
+	for(auto & column : columns)
+		query += ", " + column.name + " " + (column.is_json ? json_type : data_type_to_db_type(column.dt)) + " NOT NULL";
+
+	query += ")";
+
+	execute_query(query);
+}
+
+std::optional<field_projection_t> db_sql::get_projection() const
+{
+	// unmapped fields go into a json column
+	if (field_mappings.unmapped_fields.empty() == false)
+		return { };
+
+	field_projection_t projection;
+
+	for(auto & mapping : field_mappings.mappings) {
+		if (mapping.second.field_id != -1)
+			projection.set(mapping.second.field_id);
+	}
+
+	return projection;
+}
+
+static_assert(db_record_max_fields <= 64, "db_sql::insert keeps track of the used fields in a 64 bit mask");
 
-		// then add all fields to query
-		for(auto & mapping : field_mappings.mappings) {
-			std::string value;
-			bool        add = false;
+// get (as text, into 'out') & mark as used in 'consumed'
+bool db_sql::pull_field_from_db_record_t(const db_record_t & data, const int field_id, uint64_t *const consumed, std::string *const out)
+{
+	int index = field_id == -1 ? -1 : data.find(field_id);
+
+	if (index == -1)
+		return false;
+
+	const db_record_field_t & field = data.get(index);
+
+	out->clear();
+
+	if (append_value(field.dt, data.get_value(index), field.len, out) == false) {
+		dolog(ll_info, "db_sql::pull_field_from_db_record_t: cannot convert \"%s\" (data-type %d) to string", field_lookup.get_name(field_id), field.dt);
+
+		return false;
+	}
+
+	*consumed |= uint64_t(1) << index;
 
-			if (mapping.second.target_is_json) {
-				if (json_fields.find(mapping.second.target_name) == json_fields.end()) {
-					json_fields.insert(mapping.second.target_name);
+	return true;
+}
+
+bool db_sql::insert(const db_record_t & dr)
+{
+	// the flusher thread uses the connection as well (escape_string())
+	std::unique_lock<std::mutex> lck(pending_lock);
 
-					auto it = json_values.find(mapping.second.target_name);
-					if (it == json_values.end()) {
-						dolog(ll_info, "db_sql::insert: json_values no longer has \"%s\"", mapping.second.target_name.c_str());
+	bool ok   = true;
+	bool fail = false;
 
-						fail = true;
-						break;
-					}
+	try {
+		// fields of 'dr' that were stored in a mapped field
+		uint64_t consumed = 0;
 
-					char *misc_str = json_dumps(it->second, 0);
+		for(size_t i=0; i<columns.size(); i++) {
+			row[i].value = nullptr;
+			row[i].len   = 0;
+			row[i].dt    = columns[i].dt;
+			row[i].text.clear();
 
-					value = misc_str;
+			json_values[i] = columns[i].is_json ? json_object() : nullptr;
+		}
 
-					free(misc_str);
+		for(auto & mapping : mappings) {
+			db_sql_value_t & v = row[mapping.column];
 
-					add = true;
+			if (mapping.is_json) {
+				// map IANA name in JSON-object to value
+				if (pull_field_from_db_record_t(dr, mapping.field_id, &consumed, &text_buffer) == false) {
+					dolog(ll_info, "db_sql::insert: data for \"%s\" missing (json)", mapping.iana_name.c_str());
+					text_buffer = "0";
 				}
+
+				json_object_set_new(json_values[mapping.column], mapping.iana_name.c_str(), json_string(text_buffer.c_str()));
+
+				continue;
 			}
-			else {
-				auto temp = pull_field_from_db_record_t(work, mapping.first);
-				if (temp.has_value() == false) {
-					dolog(ll_info, "db_sql::insert: data for \"%s\" missing (non-json)", mapping.first.c_str());
-					value = "0";
-				}
-				else {
-					value = temp.value();
-				}
 
-				add = true;
+			int index = mapping.field_id == -1 ? -1 : dr.find(mapping.field_id);
+
+			if (index == -1) {
+				dolog(ll_info, "db_sql::insert: data for \"%s\" missing (non-json)", mapping.iana_name.c_str());
+				v.text = "0";
+
+				continue;
 			}
 
-			if (add)
-				query += ", '" + escape_string(value) + "'";
+			// converted (or bound as is) by queue_row()
+			const db_record_field_t & field = dr.get(index);
+
+			v.value = dr.get_value(index);
+			v.len   = field.len;
+			v.dt    = field.dt;
+
+			consumed |= uint64_t(1) << index;
 		}
 
 		// left-over fields
-		json_t *unmapped_fields = json_object();
-		if (field_mappings.unmapped_fields.empty() == false && !fail) {
-			// get
-			while(work.data.empty() == false) {
-				std::string field = work.data.begin()->first;
+		if (field_mappings.unmapped_fields.empty() == false) {
+			json_t *unmapped_fields = json_values.back();
+
+			for(int i=0; i<dr.size(); i++) {
+				if (consumed & (uint64_t(1) << i))
+					continue;
+
+				const db_record_field_t & field_info = dr.get(i);
+				const char              * field      = field_lookup.get_name(field_info.field_id);
 
-				auto value = pull_field_from_db_record_t(work, field);
-				if (value.has_value() == false) {
-					dolog(ll_info, "db_sql::insert: data for \"%s\" missing (unmapped)", field.c_str());
+				text_buffer.clear();
+
+				if (field == nullptr || append_value(field_info.dt, dr.get_value(i), field_info.len, &text_buffer) == false) {
+					dolog(ll_info, "db_sql::insert: data for field %d missing (unmapped)", field_info.field_id);
 
 					fail = true;
 					break;
 				}
 
-				json_object_set(unmapped_fields, field.c_str(), json_string(value.value().c_str()));
+				json_object_set_new(unmapped_fields, field, json_string(text_buffer.c_str()));
 			}
+		}
 
-			// add to query
-			char *unmapped_fields_str = json_dumps(unmapped_fields, 0);
-
-			std::string value = unmapped_fields_str;
-
-			free(unmapped_fields_str);
+		for(size_t i=0; i<columns.size() && !fail; i++) {
+			if (json_values[i] == nullptr)
+				continue;
 
-			query += ", '" + escape_string(value) + "'";
-		}
+			char *json_str = json_dumps(json_values[i], 0);
 
-		query += ")";
+			row[i].text = json_str;
 
-		if (!fail) {
-			execute_query(query);
-			commit();
+			free(json_str);
 		}
 
-		for(auto element : json_values)
-			json_decref(element.second);
-
-		json_decref(unmapped_fields);
+		if (!fail)
+			add_row();
 	}
 	catch(const std::string & s) {
 		dolog(ll_warning, "db_sql::insert: problem during record insertion: %s", s.c_str());
 
-		return false;
+		ok = false;
 	}
 
-	return true;
+	for(auto & element : json_values) {
+		if (element) {
+			json_decref(element);
+			element = nullptr;
+		}
+	}
+
+	return ok;
 }
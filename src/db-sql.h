@@ -1,17 +1,93 @@
 #pragma once
+#include <condition_variable>
+#include <jansson.h>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "db.h"
 #include "db-common.h"
 
 
+// a column of the records table, after the "ts" column
+typedef struct
+{
+	std::string    name;
+	bool           is_json;
+	// IANA type of the mapped field; not used for json columns
+	data_type_t    dt;
+} db_sql_column_t;
+
+// the value for a column, in one row
+typedef struct
+{
+	// a field of the record (in network order), nullptr when 'text' holds
+	// the value (json columns and fields that are missing)
+	const uint8_t *value;
+	int            len;
+	data_type_t    dt;
+	std::string    text;
+} db_sql_value_t;
+
 class db_sql : public db
 {
+private:
+	typedef struct
+	{
+		std::string    iana_name;
+		int            field_id;
+		bool           is_json;
+		// index in 'columns'
+		size_t         column;
+	} mapping_t;
+
+	const db_sql_batching_t    batching;
+
+	std::vector<mapping_t>     mappings;
+
+	// "INSERT INTO records(...) VALUES"
+	std::string                insert_prefix;
+
+	// rows that were not written yet; queue_row() of db_sql adds them to
+	// 'pending' as insert_prefix followed by "(...),(...)"
+	std::mutex                 pending_lock;
+	std::string                pending;
+	int                        n_pending     { 0 };
+	size_t                     pending_bytes { 0 };
+	uint64_t                   pending_since { 0 };
+
+	// a copy of the pending rows: when writing a batch fails, every row is
+	// retried on its own so that one bad value does not cost the others.
+	// columns.size() values per row; fields are copied into 'retry_bytes'
+	std::vector<db_sql_value_t> retry_values;
+	std::vector<size_t>        retry_offsets;
+	std::string                retry_bytes;
+
+	// re-used for every row
+	std::vector<db_sql_value_t> row;
+	std::vector<json_t *>      json_values;
+	std::string                text_buffer;
+
+	// writes the rows after max_delay_ms, when there is no more traffic
+	std::thread               *flusher       { nullptr };
+	std::condition_variable    flusher_cv;
+	bool                       stop_flusher  { false };
+
+	// these three with pending_lock held
+	void                       add_row();
+	bool                       flush_pending();
+	int                        retry_rows(const int n_rows);
+	void                       run_flusher();
+
 protected:
 	const db_field_mappings_t  field_mappings;
 
-	std::optional<std::string> pull_field_from_db_record_t(db_record_t & data, const std::string & key);
+	// in the order of the INSERT, json columns once
+	std::vector<db_sql_column_t> columns;
+
+	bool                       pull_field_from_db_record_t(const db_record_t & data, const int field_id, uint64_t *const consumed, std::string *const out);
 
 	std::string                timestamp_type { "" };
 	std::string                json_type      { "" };
@@ -19,14 +95,31 @@ protected:
 	virtual std::string        data_type_to_db_type(const data_type_t dt) = 0;
 
 	virtual std::string        escape_string(const std::string & in) = 0;
+	// literal for the bytes of an octetArray value, given as hex; it is
+	// stored as is, like the bulk and COPY paths do
+	virtual std::string        binary_literal(const std::string & hex) = 0;
 	virtual bool               execute_query(const std::string & q) = 0;
 	virtual bool               commit() = 0;
 
+	// how rows are sent; the default is a multi-row INSERT with the values as
+	// (escaped) text. invoked with pending_lock held (so also by the flusher
+	// thread). queue_row() returns the (approximate) number of bytes it added
+	// and must copy what it uses of 'values'.
+	virtual size_t             queue_row(const std::vector<db_sql_value_t> & values);
+	virtual bool               write_rows();
+	virtual void               clear_rows();
+
+	// writes what is pending; must be called by the destructor of the
+	// sub-class (while execute_query() still works)
+	void                       stop_flushing();
+
 public:
-	db_sql(const db_field_mappings_t & field_mappings);
+	db_sql(const db_field_mappings_t & field_mappings, const db_sql_batching_t & batching);
 	virtual ~db_sql();
 
 	virtual void init_database() override;
 
+	std::optional<field_projection_t> get_projection() const override;
+
 	virtual bool insert(const db_record_t & dr);
 };
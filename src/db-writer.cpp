@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "db-writer.h"
+#include "logging.h"
+
+
+// records a writer takes from its queue at once
+constexpr size_t writer_batch_size = 256;
+
+db_writer::db_writer(const std::vector<db *> & targets, const int queue_size, const bool ordered) :
+	targets(targets),
+	ordered(ordered)
+{
+	size_t n_queues = ordered ? targets.size() : 1;
+
+	for(size_t i=0; i<n_queues; i++)
+		queues.push_back(new mpmc_queue<db_record_t>(queue_size));
+
+	for(size_t i=0; i<targets.size(); i++)
+		threads.push_back(new std::thread([this, i] { this->run(i); }));
+
+	dolog(ll_info, "db_writer: %zu writer(s), %s", targets.size(), ordered ? "ordered per observation domain" : "unordered");
+}
+
+db_writer::~db_writer()
+{
+	// the writers store what is left
+	stopping = true;
+
+	for(auto q : queues)
+		q->stop();
+
+	for(auto th : threads) {
+		th->join();
+		delete th;
+	}
+
+	for(size_t i=0; i<queues.size(); i++) {
+		dolog(ll_info, "db_writer::~db_writer: queue %zu high-water mark: %zu of %zu, waited %lu times for room", i, queues[i]->get_high_water_mark(), queues[i]->get_size(), queues[i]->get_n_full_waits());
+
+		delete queues[i];
+	}
+
+	// (these flush their own batches)
+	std::vector<db *> unique_targets = targets;
+	std::sort(unique_targets.begin(), unique_targets.end());
+	unique_targets.erase(std::unique(unique_targets.begin(), unique_targets.end()), unique_targets.end());
+
+	for(auto t : unique_targets)
+		delete t;
+}
+
+void db_writer::init_database()
+{
+	targets.at(0)->init_database();
+}
+
+std::optional<field_projection_t> db_writer::get_projection() const
+{
+	return targets.at(0)->get_projection();
+}
+
+mpmc_queue<db_record_t> *db_writer::select_queue(const uint64_t exporter, const uint32_t observation_domain_id)
+{
+	if (ordered == false)
+		return queues[0];
+
+	// domains are only unique per exporter
+	uint64_t h = (exporter ^ observation_domain_id) * 0x9e3779b97f4a7c15ull;
+
+	return queues[(h >> 32) % queues.size()];
+}
+
+bool db_writer::insert(const db_record_t & dr)
+{
+	db_record_t copy = dr;
+
+	// it is stored after the receiver re-used its buffer: copy the datagram
+	// up to the last value. a pool buffer it is in is not kept, that would
+	// hold 64 kB per queued record.
+	size_t len = 0;
+
+	for(int i=0; i<copy.size(); i++)
+		len = std::max(len, size_t(copy.get(i).offset) + copy.get(i).len);
+
+	copy.packet = packet_ref::copy(copy.base, len);
+	copy.base   = copy.packet.get();
+
+	return select_queue(dr.exporter, dr.observation_domain_id)->push(&copy, 1);
+}
+
+bool db_writer::insert_batch(const db_record_batch_t & batch)
+{
+	// per producer (worker), re-used
+	thread_local std::vector<db_record_t> records;
+
+	records.resize(batch.n_records);
+
+	// see insert(); one copy for all records of the set
+	size_t len = 0;
+
+	for(auto & column : batch.columns) {
+		for(size_t i=0; i<batch.n_records; i++)
+			len = std::max(len, size_t(column.values[i] - batch.base) + column.lengths[i]);
+	}
+
+	packet_ref     packet = packet_ref::copy(batch.base, len);
+	const uint8_t *base   = packet.get();
+
+	for(size_t i=0; i<batch.n_records; i++) {
+		db_record_t & dr = records[i];
+
+		dr = db_record_t();
+		dr.export_time           = batch.export_time;
+		dr.sequence_number       = batch.sequence_number;
+		dr.observation_domain_id = batch.observation_domain_id;
+		dr.exporter              = batch.exporter;
+		dr.base                  = batch.base;
+
+		for(auto & column : batch.columns) {
+			// compile_decode_plan() keeps the columns within db_record_max_fields
+			if (dr.add(column.field_id, column.dt, column.values[i], column.lengths[i]) == false)
+				break;
+		}
+
+		// the offsets stay the same
+		dr.base   = base;
+		dr.packet = packet;
+	}
+
+	return select_queue(batch.exporter, batch.observation_domain_id)->push(records.data(), batch.n_records);
+}
+
+void db_writer::run(const int nr)
+{
+	mpmc_queue<db_record_t> *queue  = queues[ordered ? nr : 0];
+	db                      *target = targets[nr];
+
+	std::vector<db_record_t> records;
+	records.reserve(writer_batch_size);
+
+	for(;;) {
+		size_t n = queue->pop(&records, writer_batch_size, 100);
+
+		if (n == 0) {
+			if (stopping)
+				break;
+
+			continue;
+		}
+
+		for(auto & dr : records)
+			target->insert(dr);
+
+		// releases the datagrams
+		records.clear();
+	}
+
+	dolog(ll_debug, "db_writer::run: writer %d stopped", nr);
+}
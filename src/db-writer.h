@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "db.h"
+#include "mpmc-queue.h"
+#include "packet.h"
+
+
+// asynchronous stage between the parsers and the storage: insert() queues
+// the record, writer threads store them, each with its own db instance (and
+// so database connection). round-trips of the connections overlap. a thread
+// safe db can be shared by all writers.
+class db_writer : public db
+{
+private:
+	// one per writer (can be the same one), owned
+	const std::vector<db *>               targets;
+	// ordered: a queue per writer, records of an observation domain (of an
+	// exporter) always go to the same one. else one queue for all writers.
+	// a queued record holds a copy of its datagram up to its last value
+	// (shared by the records of a set), not the receive buffer.
+	const bool                            ordered;
+	std::vector<mpmc_queue<db_record_t> *> queues;
+	std::vector<std::thread *>            threads;
+	std::atomic_bool                      stopping { false };
+
+	mpmc_queue<db_record_t>              *select_queue(const uint64_t exporter, const uint32_t observation_domain_id);
+	void                                  run(const int nr);
+
+public:
+	// takes ownership of 'targets'
+	// queue_size: number of records that can wait (per queue)
+	db_writer(const std::vector<db *> & targets, const int queue_size, const bool ordered);
+	virtual ~db_writer();
+
+	void init_database() override;
+
+	// the writers serialize access to the targets
+	bool is_thread_safe() const override { return true; }
+
+	std::optional<field_projection_t> get_projection() const override;
+
+	bool insert      (const db_record_t & dr) override;
+	bool insert_batch(const db_record_batch_t & batch) override;
+};
@@ -17,3 +17,29 @@ db::db()
 db::~db()
 {
 }
+
+bool db::insert_batch(const db_record_batch_t & batch)
+{
+	bool ok = true;
+
+	for(size_t i=0; i<batch.n_records; i++) {
+		db_record_t dr;
+		dr.export_time           = batch.export_time;
+		dr.sequence_number       = batch.sequence_number;
+		dr.observation_domain_id = batch.observation_domain_id;
+		dr.exporter              = batch.exporter;
+		dr.base                  = batch.base;
+		dr.packet                = batch.packet;
+
+		for(auto & column : batch.columns) {
+			// compile_decode_plan() keeps the columns within db_record_max_fields
+			if (dr.add(column.field_id, column.dt, column.values[i], column.lengths[i]) == false)
+				break;
+		}
+
+		if (insert(dr) == false)
+			ok = false;
+	}
+
+	return ok;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <map>
+#include <optional>
 #include <stdint.h>
 #include <string>
 #include <time.h>
@@ -16,5 +17,14 @@ public:
 
 	virtual void init_database() = 0;
 
+	// when true, one instance can be shared by all workers
+	virtual bool is_thread_safe() const { return false; }
+
+	// the fields this sink uses; the parsers skip all others. no value
+	// when it stores all fields.
+	virtual std::optional<field_projection_t> get_projection() const { return { }; }
+
 	virtual bool insert(const db_record_t & dr) = 0;
+	// default: insert() for each record
+	virtual bool insert_batch(const db_record_batch_t & batch);
 };
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <vector>
+
+#include "db-common.h"
+#include "decode-plan.h"
+#include "logging.h"
+
+
+static bool is_integer_type(const data_type_t type, const int field_length)
+{
+	if (field_length < 1 || field_length > 8)
+		return false;
+
+	switch(type) {
+		case dt_unsigned8:
+		case dt_unsigned16:
+		case dt_unsigned32:
+		case dt_unsigned64:
+		case dt_signed8:
+		case dt_signed16:
+		case dt_signed32:
+		case dt_signed64:
+		case dt_dateTimeSeconds:
+		case dt_dateTimeMilliseconds:
+		case dt_dateTimeMicroseconds:
+		case dt_dateTimeNanoseconds:
+			return true;
+
+		case dt_ipv4Address:
+			return field_length == 4;
+
+		default:
+			break;
+	}
+
+	return false;
+}
+
+// pairs integer fields that are within 16 bytes of each other
+static void compile_swap_chunks(decode_plan_t *const plan)
+{
+	swap_chunk_t *chunk = nullptr;
+
+	for(auto & field : plan->fields) {
+		if (field.integer == false)
+			continue;
+
+		int half = 1;
+
+		if (chunk == nullptr || chunk->column[1] != -1 || field.offset + field.field_length > chunk->offset + 16) {
+			plan->swap_chunks.push_back({ });
+
+			chunk = &plan->swap_chunks.back();
+			chunk->offset    = field.offset;
+			chunk->column[0] = chunk->column[1] = -1;
+
+			for(int i=0; i<16; i++)
+				chunk->shuffle[i] = 0x80;  // zero
+
+			half = 0;
+		}
+
+		// most significant byte first in the record, last in the result
+		for(int i=0; i<field.field_length; i++)
+			chunk->shuffle[half * 8 + i] = field.offset - chunk->offset + field.field_length - 1 - i;
+
+		chunk->column[half] = field.column;
+
+		plan->swap_reach = std::max(plan->swap_reach, chunk->offset + 16);
+	}
+}
+
+decode_plan_t compile_decode_plan(const std::vector<information_element_t> & template_, const field_projection_t *const projection)
+{
+	decode_plan_t plan { };
+	plan.fixed_length = true;
+
+	int offset    = 0;
+	int n_surplus = 0;
+
+	for(auto & ie : template_) {
+		decode_field_t field { };
+		field.information_element_identifier = ie.information_element_identifier;
+		field.field_length                   = ie.field_length;
+		field.offset                         = plan.fixed_length ? offset : -1;
+
+		auto element = ie.enterprise ? field_lookup.get(ie.enterprise_number, ie.information_element_identifier) : field_lookup.get(ie.information_element_identifier);
+
+		if (element && projection && projection->test(element->field_id) == false) {
+			field.type     = element->type;
+			field.name     = element->name;
+			field.field_id = element->field_id;
+			field.column   = -1;
+
+			dolog(ll_debug, "compile_decode_plan: information element %s is not used, it will be skipped", element->name);
+		}
+		else if (element && plan.n_columns == db_record_max_fields) {
+			// a db_record_t holds at most that many fields
+			field.type     = element->type;
+			field.name     = element->name;
+			field.field_id = element->field_id;
+			field.column   = -1;
+
+			n_surplus++;
+		}
+		else if (element) {
+			field.type     = element->type;
+			field.name     = element->name;
+			field.field_id = element->field_id;
+			field.column   = plan.n_columns++;
+			field.integer  = is_integer_type(field.type, ie.field_length);
+		}
+		else {
+			field.type     = dt_reserved;
+			field.column   = -1;
+
+			if (ie.enterprise)
+				dolog(ll_debug, "compile_decode_plan: enterprise %u information element %d is not known, it will be skipped", ie.enterprise_number, ie.information_element_identifier);
+			else
+				dolog(ll_debug, "compile_decode_plan: information element %d is not known, it will be skipped", ie.information_element_identifier);
+		}
+
+		if (ie.field_length == variable_length) {
+			plan.fixed_length = false;
+			plan.record_length += 1;  // at least the length byte
+		}
+		else {
+			offset             += ie.field_length;
+			plan.record_length += ie.field_length;
+		}
+
+		plan.fields.push_back(field);
+	}
+
+	if (n_surplus)
+		dolog(ll_warning, "compile_decode_plan: template has more than %d known fields, the last %d will be skipped", db_record_max_fields, n_surplus);
+
+	if (plan.fixed_length)
+		compile_swap_chunks(&plan);
+	else {
+		for(auto & field : plan.fields)
+			field.integer = false;
+	}
+
+	return plan;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "ipfix-common.h"
+
+
+// field_length of a variable length information element (RFC 7011 7.)
+constexpr uint16_t variable_length = 65535;
+
+typedef struct
+{
+	uint16_t           information_element_identifier;
+	uint16_t           field_length;
+	// from the start of the record; -1 when behind a variable length field
+	int                offset;
+	data_type_t        type;
+	// from field_lookup; nullptr when the element is not known
+	const char        *name;
+	uint16_t           field_id;
+	// in the record batch, -1 for unknown elements and elements that are
+	// not projected: they are skipped
+	int                column;
+	// (reduced size) integer in a fixed length record: decoded into
+	// db_column_t::integers
+	bool               integer;
+} decode_field_t;
+
+// byte swaps and widens up to two integer fields of a record with one
+// 16 byte load and shuffle (see column-decode.h)
+typedef struct
+{
+	// of the load, from the start of the record
+	int                offset;
+	uint8_t            shuffle[16];
+	// target of each 64 bit half, -1 when not used
+	int                column[2];
+} swap_chunk_t;
+
+// a template, compiled when it arrives so that decoding data records does
+// not need any lookups
+typedef struct
+{
+	std::vector<decode_field_t> fields;
+	// all fields have a fixed length; then every record is 'record_length'
+	// bytes, else that is the minimum length of a record
+	bool                        fixed_length;
+	int                         record_length;
+	// fields with a known information element
+	int                         n_columns;
+	// fixed length only
+	std::vector<swap_chunk_t>   swap_chunks;
+	// the loads of 'swap_chunks' read up to this many bytes of a record
+	int                         swap_reach;
+} decode_plan_t;
+
+// 'projection': the fields to decode, nullptr for all
+decode_plan_t compile_decode_plan(const std::vector<information_element_t> & template_, const field_projection_t *const projection);
@@ -1,8 +1,10 @@
 #pragma once
-#include <map>
+#include <bitset>
+#include <deque>
 #include <optional>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 
 typedef struct
@@ -40,19 +42,64 @@ typedef enum {
 	dt_subTemplateMultiList
 } data_type_t;
 
+// field ids are the IANA information element ids, enterprise specific
+// elements are numbered after those; all are below this
+constexpr int field_id_max = 1024;
+
+// a set of field ids, e.g. the fields a sink uses (db::get_projection())
+typedef std::bitset<field_id_max> field_projection_t;
+
+typedef struct
+{
+	// nullptr when the id is not assigned
+	const char  *name;
+	data_type_t  type;
+	uint16_t     field_id;
+} ie_registry_entry_t;
+
+// IANA information elements (generated from the registry at build time) and
+// enterprise specific ones (loaded from dictionaries)
 class fields
 {
 private:
-	std::map<uint16_t, std::pair<std::string, data_type_t> > field_types;
-	std::map<std::string, data_type_t>                       field_data_types;
+	typedef struct
+	{
+		uint32_t            enterprise_number;
+		uint16_t            information_element_identifier;
+		ie_registry_entry_t entry;
+	} enterprise_ie_t;
+
+	// perfect hash on (enterprise number, id): no collisions for 'seed'
+	std::vector<enterprise_ie_t>     enterprise_table;
+	uint32_t                         enterprise_seed { 0 };
+	// stable storage for the names in 'enterprise_table'
+	std::deque<std::string>          enterprise_names;
+	// by field id (minus the first enterprise field id)
+	std::vector<ie_registry_entry_t> enterprise_entries;
+
+	static uint32_t enterprise_hash(const uint32_t enterprise_number, const uint16_t information_element_identifier, const uint32_t seed);
+	bool            build_enterprise_table(const std::vector<enterprise_ie_t> & elements);
 
 public:
 	fields();
 	virtual ~fields();
 
-	std::optional<std::pair<std::string, data_type_t> > get_data(const uint16_t information_element_identifier);
+	// lines of "enterprise number,element id,name,abstract data type"; must be
+	// done before any packet is processed
+	bool load_enterprise_dictionary(const std::string & file);
+
+	// nullptr if not known
+	const ie_registry_entry_t *get(const uint16_t information_element_identifier) const;
+	const ie_registry_entry_t *get(const uint32_t enterprise_number, const uint16_t information_element_identifier) const;
 
-	std::optional<data_type_t>                          get_data_type(const std::string & field_name);
+	// nullptr if not known
+	const char                *get_name(const uint16_t field_id) const;
+
+	// case insensitive
+	std::optional<uint16_t>    get_field_id(const std::string & field_name) const;
+	std::optional<data_type_t> get_data_type(const std::string & field_name) const;
 };
 
+std::optional<data_type_t> str_to_data_type(const std::string & name);
+
 extern fields field_lookup;
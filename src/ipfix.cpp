@@ -1,10 +1,12 @@
 #include <time.h>
 
 #include "buffer.h"
+#include "column-decode.h"
 #include "ipfix.h"
 #include "logging.h"
 #include "net.h"
-#include "str.h"
+#include "protocol-traits.h"
+#include "value-format.h"
 
 
 ipfix::ipfix()
@@ -13,73 +15,118 @@ ipfix::ipfix()
 
 ipfix::~ipfix()
 {
-	templates.clear();
 }
 
-bool ipfix::process_packet(const uint8_t *const packet, const int packet_size, db *const target)
+void ipfix::set_projection(const std::optional<field_projection_t> & projection)
 {
-	buffer b(packet, packet_size);
+	this->projection = projection;
 
-	dolog(ll_debug, "process_ipfix_packet: packet size          : %d", packet_size);
+	if (projection.has_value())
+		dolog(ll_debug, "ipfix::set_projection: %zu field(s) will be decoded", projection.value().count());
+}
+
+// the message loop of IPFIX and NetFlow v9; 'T' (protocol-traits.h) has
+// what differs, so that each gets its own specialized copy
+template <typename T>
+bool ipfix::decode_message(const packet_t & packet, db *const target)
+{
+	buffer_view b(packet.data, packet.len);
+
+	dolog(ll_debug, "%s: packet size          : %d", T::log_name, packet.len);
 
 	// message header
-	uint16_t version_number        = b.get_net_short();
-	if (version_number != 10) {
-		dolog(ll_warning, "process_netflow_v5_packet: not a IPFIX packet (NetFlow v%d instead)", version_number);
+	if (b.has(T::header_length) == false) {
+		dolog(ll_warning, "%s: packet too short (%d bytes)", T::log_name, packet.len);
 
 		return false;
 	}
 
-	uint16_t length                = b.get_net_short();
-	time_t   export_time           = b.get_net_long ();
-	uint32_t sequence_number       = b.get_net_long ();
-	uint32_t observation_domain_id = b.get_net_long ();
+	uint16_t version_number = b.get_net_short_unchecked();
+	if (version_number != T::version) {
+		dolog(ll_warning, "%s: not a version %d packet (%d instead)", T::log_name, T::version, version_number);
 
-	dolog(ll_debug, "process_ipfix_packet: version number       : %d", version_number);
-	dolog(ll_debug, "process_ipfix_packet: length               : %d", length);
-	dolog(ll_debug, "process_ipfix_packet: export time          : %ld", export_time);
-	dolog(ll_debug, "process_ipfix_packet: sequence number      : %d", sequence_number);
-	dolog(ll_debug, "process_ipfix_packet: observation domain id: %d", observation_domain_id);
+		return false;
+	}
 
-	while(b.end_reached() == false) {
-		// set-header
-		uint16_t set_id     = b.get_net_short();
-		uint16_t set_length = b.get_net_short();
+	dolog(ll_debug, "%s: version number       : %d", T::log_name, version_number);
+
+	message_header_t header { };
+	T::get_header(b, &header);
+
+	int sets_length = packet.len - T::header_length;
 
-		dolog(ll_debug, "process_ipfix_packet: set id    : %d", set_id);
-		dolog(ll_debug, "process_ipfix_packet: set length: %d", set_length);
+	if (T::has_message_length) {
+		if (header.length < T::header_length || header.length > packet.len) {
+			dolog(ll_warning, "%s: message length %d invalid for packet of %d bytes", T::log_name, header.length, packet.len);
 
-		if (set_length < 4) {
-			dolog(ll_debug, "process_ipfix_packet: set length invalid, must be at least 4");
 			return false;
 		}
 
-		buffer set = b.get_segment(set_length - 4);
+		sets_length = header.length - T::header_length;
+	}
+
+	exporter_templates *exporter = templates.get_exporter(packet.from, header.domain);
 
-		if (set_id == 0 || set_id == 1) {  // not used (RFC3954)
-			dolog(ll_debug, "process_ipfix_packet: set id 0 and 1 should not occur");
+	// the sets of this message; anything beyond it is not part of it
+	buffer_view sets(b.get_bytes_unchecked(sets_length), sets_length);
+
+	while(sets.end_reached() == false) {
+		// set-header
+		if (sets.has(4) == false) {
+			dolog(ll_warning, "%s: set header truncated", T::log_name);
+
+			return false;
+		}
+
+		uint16_t set_id     = sets.get_net_short_unchecked();
+		uint16_t set_length = sets.get_net_short_unchecked();
+
+		dolog(ll_debug, "%s: set id    : %d", T::log_name, set_id);
+		dolog(ll_debug, "%s: set length: %d", T::log_name, set_length);
+
+		buffer_view set;
+
+		if (set_length < 4 || sets.get_segment(set_length - 4, &set) == false) {
+			dolog(ll_warning, "%s: set length %d invalid, must be at least 4 and within the message", T::log_name, set_length);
 
 			return false;
 		}
-		else if (set_id == 2) {  // template record
-			uint16_t template_id = set.get_net_short();
-			uint16_t field_count = set.get_net_short();
 
-			dolog(ll_debug, "process_ipfix_packet: template id: %d", template_id);
-			dolog(ll_debug, "process_ipfix_packet: field count: %d", field_count);
+		if (set_id == T::template_set_id) {  // template record
+			if (set.has(4) == false) {
+				dolog(ll_warning, "%s: template record header truncated", T::log_name);
+
+				return false;
+			}
+
+			uint16_t template_id = set.get_net_short_unchecked();
+			uint16_t field_count = set.get_net_short_unchecked();
+
+			dolog(ll_debug, "%s: template id: %d", T::log_name, template_id);
+			dolog(ll_debug, "%s: field count: %d", T::log_name, field_count);
 
 			std::vector<information_element_t> template_;
 
 			for(uint16_t nr=0; nr<field_count; nr++) {
-				uint16_t ie_identifier     = set.get_net_short();  // information element identifier
-				bool     enterprise        = !!(ie_identifier & 32768);
-				uint16_t field_length      = set.get_net_short();
+				if (set.has(4) == false) {
+					dolog(ll_warning, "%s: template %d truncated at field %d", T::log_name, template_id, nr);
+
+					return false;
+				}
+
+				uint16_t ie_identifier     = set.get_net_short_unchecked();  // information element identifier
+				bool     enterprise        = T::has_enterprise_bit && (ie_identifier & 32768);
+				uint16_t field_length      = set.get_net_short_unchecked();
 				uint32_t enterprise_number = 0;
 
-				ie_identifier &= 32767;
+				if (T::has_enterprise_bit)
+					ie_identifier &= 32767;
 
-				if (enterprise)
-					enterprise_number  = set.get_net_long();
+				if (enterprise && set.get_net_long(&enterprise_number) == false) {
+					dolog(ll_warning, "%s: template %d truncated at enterprise number of field %d", T::log_name, template_id, nr);
+
+					return false;
+				}
 
 				information_element_t ie { 0 };
 				ie.enterprise                     = enterprise;
@@ -88,81 +135,60 @@ bool ipfix::process_packet(const uint8_t *const packet, const int packet_size, d
 				ie.enterprise_number              = enterprise_number;
 
 				if (enterprise)
-					dolog(ll_debug, "process_ipfix_packet: field %d is type %d and is enterprise, length is %d bytes (enterprise number: %d)", nr, ie_identifier, field_length, enterprise_number);
+					dolog(ll_debug, "%s: field %d is type %d and is enterprise, length is %d bytes (enterprise number: %d)", T::log_name, nr, ie_identifier, field_length, enterprise_number);
 				else
-					dolog(ll_debug, "process_ipfix_packet: field %d is type %d and is not enterprise, length is %d bytes", nr, ie_identifier, field_length);
+					dolog(ll_debug, "%s: field %d is type %d, length is %d bytes", T::log_name, nr, ie_identifier, field_length);
 
 				template_.push_back(ie);
 			}
 
-			templates.insert_or_assign(template_id, template_);
+			exporter->put(template_id, compile_decode_plan(template_, projection.has_value() ? &projection.value() : nullptr));
 
 			if (set.end_reached() == false) {
-				dolog(ll_warning, "process_ipfix_packet: data (set) underflow (%d bytes left)", set.get_n_bytes_left());
+				dolog(ll_warning, "%s: data (set) underflow (%d bytes left)", T::log_name, set.get_n_bytes_left());
 
 				return false;
 			}
 		}
-		else if (set_id == 3) {  // options template sets
-			dolog(ll_warning, "process_ipfix_packet: options template sets not implemented");
-
-			// return false;
+		else if (set_id == T::options_template_set_id) {  // options template sets
+			dolog(ll_warning, "%s: options template sets not implemented", T::log_name);
 		}
 		else if (set_id >= 256) {  // data sets
-			auto data_set = templates.find(set_id);
+			const decode_plan_t *data_set = exporter->get(set_id);
 
-			if (data_set == templates.end()) {
-				dolog(ll_debug, "process_ipfix_packet: template %d not set (yet)", set_id);
+			if (!data_set) {
+				dolog(ll_debug, "%s: template %d not set (yet)", T::log_name, set_id);
 
 				return false;
 			}
 
-			dolog(ll_debug, "process_ipfix_packet: template %d has %zu elements", set_id, data_set->second.size());
-
-			db_record_t db_record;
-			db_record.export_time           = export_time;
-			db_record.sequence_number       = sequence_number;
-			db_record.observation_domain_id = observation_domain_id;
-
-			for(auto field : data_set->second) {
-				auto element = field_lookup.get_data(field.information_element_identifier);
-
-				if (element.has_value() == false) {
-					dolog(ll_warning, "process_ipfix_packet: information element identifier %d is not known", field.information_element_identifier);
-
-					return false;
-				}
-
-				// value, type of value (e.g. int, float, string), length of it
-				db_record_data_t drd { set.get_segment(field.field_length), element.value().second, field.field_length };
+			dolog(ll_debug, "%s: template %d has %zu elements", T::log_name, set_id, data_set->fields.size());
 
-				if (log_enabled(ll_debug)) {
-					buffer copy = drd.b;
+			batch.export_time           = header.export_time;
+			batch.sequence_number       = header.sequence_number;
+			batch.observation_domain_id = header.domain;
+			batch.exporter              = hash_address(packet.from);
+			batch.base                  = packet.data;
+			batch.packet                = packet.buffer;
 
-					std::optional<std::string> data = data_to_str(element.value().second, field.field_length, copy);
+			if (decode_set(*data_set, set, &batch) == false) {
+				dolog(ll_warning, "%s: cannot decode records of template %d", T::log_name, set_id);
 
-					if (data.has_value() == false) {
-						dolog(ll_debug, "process_ipfix_packet: information element %s of type %d: cannot convert, type not supported or invalid data", element.value().first.c_str(), element.value().second);
-
-						return false;
-					}
-
-					dolog(ll_debug, "process_ipfix_packet: information element %s of type %d: \"%s\"", element.value().first.c_str(), element.value().second, data.value().c_str());
-				}
-
-				db_record.data.insert({ element.value().first, drd });
+				return false;
 			}
 
+			dolog(ll_debug, "%s: %zu records in set", T::log_name, batch.n_records);
+
 			if (target)
-				target->insert(db_record);
+				target->insert_batch(batch);
 		}
-		else {
-			dolog(ll_error, "process_ipfix_packet: set type %d not implemented", set_id);
+		else {  // reserved
+			dolog(ll_error, "%s: set type %d not implemented", T::log_name, set_id);
 		}
 	}
 
 	if (b.end_reached() == false) {
-		dolog(ll_warning, "process_ipfix_packet: data (packet) underflow (%d bytes left)", b.get_n_bytes_left());
+		dolog(ll_warning, "%s: data (packet) underflow (%d bytes left)", T::log_name, b.get_n_bytes_left());
 
 		return false;
 	}
@@ -170,164 +196,118 @@ bool ipfix::process_packet(const uint8_t *const packet, const int packet_size, d
 	return true;
 }
 
-std::optional<std::string> ipfix::data_to_str(const data_type_t & type, const int len, buffer & data_source)
+template bool ipfix::decode_message<ipfix_traits>     (const packet_t & packet, db *const target);
+template bool ipfix::decode_message<netflow_v9_traits>(const packet_t & packet, db *const target);
+
+bool ipfix::process_packet(const packet_t & packet, db *const target)
 {
-	std::optional<std::string> out = { };
-	int expected_length = -1;
-
-	switch(type) {
-		case dt_octetArray: {
-				expected_length = len;
-
-				std::string temp;
-
-				for(int i=0; i<len; i++)
-					temp += myformat("%02x", data_source.get_byte());
-
-				out = temp;
-		    	}
-			break;
-
-		case dt_unsigned8:
-			expected_length = 1;
-			out = myformat("%u", data_source.get_byte());
-			break;
-
-		case dt_unsigned16:
-			expected_length = len <= 2 ? len : 2;
-			out = myformat("%u", uint16_t(get_variable_size_integer(data_source, len)));
-			break;
-
-		case dt_unsigned32:
-			expected_length = len <= 4 ? len : 4;
-			out = myformat("%u", uint32_t(get_variable_size_integer(data_source, len)));
-			break;
-
-		case dt_unsigned64:
-			expected_length = len <= 8 ? len : 8;
-			out = myformat("%lu", get_variable_size_integer(data_source, len));
-			break;
-
-		case dt_signed8:
-			expected_length = 1;
-			out = myformat("%d", static_cast<int8_t>(data_source.get_byte()));
-			break;
-
-		case dt_signed16:
-			expected_length = 2;
-			out = myformat("%d", static_cast<int16_t>(data_source.get_net_short()));
-			break;
-
-		case dt_signed32:
-			expected_length = 4;
-			out = myformat("%d", static_cast<int32_t>(data_source.get_net_long()));
-			break;
-
-		case dt_signed64:
-			expected_length = 8;
-			out = myformat("%ld", static_cast<int64_t>(data_source.get_net_long_long()));
-			break;
-
-		case dt_float32: {
-				expected_length = 4;
-				uint32_t temp = data_source.get_net_long();
-				out = myformat("%f", *reinterpret_cast<float *>(&temp));
-			}
-			break;
+	return decode_message<ipfix_traits>(packet, target);
+}
 
-		case dt_float64: {
-				expected_length = 8;
-				uint64_t temp = data_source.get_net_long();
-				out = myformat("%f", *reinterpret_cast<double *>(&temp));
-			}
-			break;
+// the length of a set is checked once, against the record length of the
+// plan; records are then sliced without further checks (fixed length) or
+// with one check per field (variable length)
+bool ipfix::decode_set(const decode_plan_t & plan, buffer_view & set, db_record_batch_t *const out)
+{
+	out->n_records = 0;
+	out->columns.resize(plan.n_columns);
 
-		case dt_boolean: {
-				expected_length = 8;
-				uint8_t v = data_source.get_byte();
+	for(const auto & field : plan.fields) {
+		if (field.column == -1)
+			continue;
 
-				if (v == 1)
-					out = "true";
-				else if (v == 2)
-					out = "false";
-				else
-					dolog(ll_warning, "ipfix::data_to_str: unexpected value %d found for type %d, expected 1 or 2", v, type);
-			}
-			break;
+		auto & column = out->columns[field.column];
 
-		case dt_macAddress: {
-				expected_length = 6;
+		column.name     = field.name;
+		column.field_id = field.field_id;
+		column.dt       = field.type;
+		column.values  .clear();
+		column.lengths .clear();
+		column.integers.clear();
+	}
 
-				uint8_t bytes[6] { 0 };
-				for(int i=0; i<6; i++)
-					bytes[i] = data_source.get_byte();
+	// anything shorter than a record at the end of the set is padding
+	if (plan.record_length == 0)
+		return true;
 
-				out = myformat("%02x:%02x:%02x:%02x:%02x:%02x", bytes[0], bytes[1], bytes[2], bytes[3], bytes[4], bytes[5]);
-			}
-			break;
+	if (plan.fixed_length) {
+		// all offsets are known: one bounds check for all records, then
+		// fill the columns one by one
+		size_t         n_bytes = set.get_n_bytes_left();
+		size_t         n       = n_bytes / plan.record_length;
+		const uint8_t *records = set.get_bytes_unchecked(n * plan.record_length);
 
-		case dt_string:
-			expected_length = len;
-			out = data_source.get_string(len);
-			break;
+		for(const auto & field : plan.fields) {
+			if (field.column == -1)
+				continue;
 
-		case dt_dateTimeSeconds:
-			expected_length = 4;
-			out = myformat("%u", data_source.get_net_long());
-			break;
+			auto & column = out->columns[field.column];
 
-		case dt_dateTimeMilliseconds:
-			expected_length = 8;
-			out = myformat("%lu", data_source.get_net_long_long());
-			break;
+			column.values .resize(n);
+			column.lengths.assign(n, field.field_length);
 
-		case dt_dateTimeMicroseconds:
-			expected_length = 8;
-			out = myformat("%lu", data_source.get_net_long_long());
-			break;
+			for(size_t i=0; i<n; i++)
+				column.values[i] = &records[i * plan.record_length + field.offset];
+		}
 
-		case dt_dateTimeNanoseconds:
-			expected_length = 8;
-			out = myformat("%lu", data_source.get_net_long_long());
-			break;
+		decode_integer_columns(plan, records, n, n_bytes, out);
 
-		case dt_ipv4Address: {
-				expected_length = 4;
+		out->n_records = n;
+	}
+	else {
+		while(set.has(plan.record_length)) {
+			for(const auto & field : plan.fields) {
+				int field_length = field.field_length;
 
-				uint8_t bytes[4] { 0 };
-				for(int i=0; i<4; i++)
-					bytes[i] = data_source.get_byte();
+				if (field_length == variable_length) {
+					uint8_t  short_length = 0;
+					uint16_t long_length  = 0;
 
-				out = myformat("%d.%d.%d.%d", bytes[0], bytes[1], bytes[2], bytes[3]);
-			}
-			break;
+					if (set.get_byte(&short_length) == false || (short_length == 255 && set.get_net_short(&long_length) == false)) {
+						dolog(ll_warning, "ipfix::decode_set: record %zu: length of variable length field truncated", out->n_records);
 
-		case dt_ipv6Address: {
-				expected_length = 16;
+						return false;
+					}
 
-				uint8_t bytes[16] { 0 };
-				for(int i=0; i<16; i++)
-					bytes[i] = data_source.get_byte();
+					field_length = short_length == 255 ? long_length : short_length;
+				}
 
-				out = myformat("%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x",
-						bytes[0], bytes[1], bytes[2], bytes[3], bytes[4], bytes[5], bytes[6], bytes[7],
-						bytes[8], bytes[9], bytes[10], bytes[11], bytes[12], bytes[13], bytes[14], bytes[15]);
-			}
-			break;
+				if (set.has(field_length) == false) {
+					dolog(ll_warning, "ipfix::decode_set: record %zu: field of %d bytes truncated", out->n_records, field_length);
+
+					return false;
+				}
+
+				const uint8_t *value = set.get_bytes_unchecked(field_length);
 
-		// case dt_basicList,
-		// case dt_subTemplateList,
-		// case dt_subTemplateMultiList
+				if (field.column == -1)
+					continue;
+
+				out->columns[field.column].values .push_back(value);
+				out->columns[field.column].lengths.push_back(field_length);
+			}
 
-		default:
-			data_source.seek(len);
-			break;
+			out->n_records++;
+		}
 	}
 
-	if (expected_length != len) {
-		dolog(ll_warning, "ipfix::data_to_str: unexpected length %d found for type %d, expected %d", len, type, expected_length);
-		return { };
+	if (log_enabled(ll_debug)) {
+		std::string data;
+
+		for(size_t i=0; i<out->n_records; i++) {
+			for(auto & column : out->columns) {
+				data.clear();
+
+				if (append_value(column.dt, column.values[i], column.lengths[i], &data) == false) {
+					dolog(ll_debug, "ipfix::decode_set: record %zu, information element %s of type %d: cannot convert, type not supported or invalid data", i, column.name, column.dt);
+
+					return false;
+				}
+
+				dolog(ll_debug, "ipfix::decode_set: record %zu, information element %s of type %d: \"%s\"", i, column.name, column.dt, data.c_str());
+			}
+		}
 	}
 
-	return out;
+	return true;
 }
@@ -1,5 +1,4 @@
 #pragma once
-#include <map>
 #include <optional>
 #include <stdint.h>
 #include <string>
@@ -8,18 +7,35 @@
 #include "buffer.h"
 #include "db.h"
 #include "ipfix-common.h"
+#include "packet.h"
+#include "template-cache.h"
 
 
 class ipfix
 {
 protected:
-	std::map<uint16_t, std::vector<information_element_t> > templates;
+	// keyed by exporter, observation domain (source id) and template id
+	template_cache templates;
+
+	// re-used for every data set
+	db_record_batch_t batch { };
+
+	// fields the target uses; no value: all
+	std::optional<field_projection_t> projection;
+
+	// IPFIX and NetFlow v9 messages, 'T' is one of protocol-traits.h
+	template <typename T>
+	bool decode_message(const packet_t & packet, db *const target);
+
+	// decodes all records in a data set
+	static bool decode_set(const decode_plan_t & plan, buffer_view & set, db_record_batch_t *const out);
 
 public:
 	ipfix();
 	virtual ~ipfix();
 
-	virtual bool process_packet(const uint8_t *const packet, const int packet_size, db *const target);
+	// applies to templates that arrive after this call
+	virtual void set_projection(const std::optional<field_projection_t> & projection);
 
-	static std::optional<std::string> data_to_str(const data_type_t & type, const int len, buffer & data_source);
+	virtual bool process_packet(const packet_t & packet, db *const target);
 };
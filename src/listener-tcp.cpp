@@ -0,0 +1,225 @@
+#include <errno.h>
+#include <stdexcept>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include "error.h"
+#include "listener-tcp.h"
+#include "logging.h"
+#include "net.h"
+#include "time.h"
+
+
+constexpr int ipfix_header_size = 16;
+constexpr int max_events        = 64;
+// a message is at most 65535 bytes: after the complete ones were processed,
+// a read() gets at least read_size bytes of room
+constexpr int read_size         = 65536;
+constexpr int buffer_size       = read_size * 2;
+
+listener_tcp::listener_tcp(const int listen_fd, db *const target, std::atomic_bool & stop_flag) :
+	listen_fd(listen_fd),
+	target(target),
+	stop_flag(stop_flag)
+{
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd == -1)
+		error_exit(true, "listener_tcp: cannot create epoll instance");
+
+	struct epoll_event ev { 0 };
+	ev.events  = EPOLLIN;
+	ev.data.fd = listen_fd;
+
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) == -1)
+		error_exit(true, "listener_tcp: cannot add listen socket to epoll instance");
+
+	th = new std::thread([this] { this->run(); });
+}
+
+listener_tcp::~listener_tcp()
+{
+	th->join();
+	delete th;
+
+	while(connections.empty() == false)
+		close_connection(connections.begin()->second);
+
+	close(epoll_fd);
+
+	close(listen_fd);
+}
+
+void listener_tcp::accept_connections()
+{
+	for(;;) {
+		connection *c = new connection { -1, { 0 }, { }, 0, nullptr };
+
+		socklen_t from_len = sizeof c->from;
+
+		c->fd = accept4(listen_fd, reinterpret_cast<sockaddr *>(&c->from), &from_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+		if (c->fd == -1) {
+			if (errno != EAGAIN && errno != EINTR)
+				dolog(ll_warning, "listener_tcp::accept_connections: cannot accept connection: %s", strerror(errno));
+
+			delete c;
+
+			return;
+		}
+
+		struct epoll_event ev { 0 };
+		ev.events  = EPOLLIN | EPOLLRDHUP;
+		ev.data.fd = c->fd;
+
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, c->fd, &ev) == -1) {
+			dolog(ll_warning, "listener_tcp::accept_connections: cannot add connection to epoll instance: %s", strerror(errno));
+
+			close(c->fd);
+			delete c;
+
+			continue;
+		}
+
+		c->data.resize(buffer_size);
+
+		c->parser = new ipfix();
+		c->parser->set_projection(target->get_projection());
+
+		connections.insert({ c->fd, c });
+
+		char host[INET6_ADDRSTRLEN] { 0 };
+
+		if (c->from.ss_family == AF_INET)
+			inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in *>(&c->from)->sin_addr, host, sizeof host);
+		else if (c->from.ss_family == AF_INET6)
+			inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6 *>(&c->from)->sin6_addr, host, sizeof host);
+
+		dolog(ll_info, "listener_tcp::accept_connections: exporter %s connected (socket %d, %zu connection(s))", host, c->fd, connections.size());
+	}
+}
+
+void listener_tcp::close_connection(connection *const c)
+{
+	dolog(ll_info, "listener_tcp::close_connection: closing socket %d (%zu bytes unprocessed)", c->fd, c->fill);
+
+	// also removes it from the epoll set
+	close(c->fd);
+
+	connections.erase(c->fd);
+
+	delete c->parser;
+	delete c;
+}
+
+bool listener_tcp::receive(connection *const c)
+{
+	ssize_t rc = read(c->fd, c->data.data() + c->fill, c->data.size() - c->fill);
+
+	if (rc > 0)
+		c->fill += rc;
+
+	if (rc == 0)  // connection closed by exporter
+		return false;
+
+	if (rc == -1) {
+		if (errno == EAGAIN || errno == EINTR)
+			return true;
+
+		dolog(ll_warning, "listener_tcp::receive: problem receiving from socket %d: %s", c->fd, strerror(errno));
+
+		return false;
+	}
+
+	return process_messages(c);
+}
+
+bool listener_tcp::process_messages(connection *const c)
+{
+	size_t offset = 0;
+
+	// a stream has no message boundaries: the header length field tells
+	// where the next message starts
+	while(c->fill - offset >= 4) {
+		const uint8_t *const p = c->data.data() + offset;
+
+		uint16_t version = get_net_short(&p[0]);
+		uint16_t length  = get_net_short(&p[2]);
+
+		if (version != 10 || length < ipfix_header_size) {
+			dolog(ll_warning, "listener_tcp::process_messages: socket %d: invalid message header (version %d, length %d), out of sync", c->fd, version, length);
+
+			return false;
+		}
+
+		if (c->fill - offset < length)
+			break;
+
+		packet_t packet { nullptr, length, c->from, get_us(), pool.get(p, length) };
+		packet.data = packet.buffer.get();
+
+		try {
+			if (c->parser->process_packet(packet, target) == false)
+				dolog(ll_error, "listener_tcp::process_messages: problem processing ipfix message");
+		}
+		catch(const std::out_of_range & e) {
+			dolog(ll_warning, "listener_tcp::process_messages: socket %d: malformed message (%s)", c->fd, e.what());
+
+			return false;
+		}
+
+		offset += length;
+	}
+
+	// the start of an incomplete message goes to the front
+	memmove(c->data.data(), c->data.data() + offset, c->fill - offset);
+	c->fill -= offset;
+
+	return true;
+}
+
+void listener_tcp::run()
+{
+	dolog(ll_info, "listener_tcp::run: listening for IPFIX over TCP (socket %d)", listen_fd);
+
+	struct epoll_event events[max_events];
+
+	try {
+		while(!stop_flag) {
+			int n = epoll_wait(epoll_fd, events, max_events, 500);
+
+			if (n == -1) {
+				if (errno == EINTR)
+					continue;
+
+				dolog(ll_error, "listener_tcp::run: problem waiting for connections: %s", strerror(errno));
+				break;
+			}
+
+			for(int i=0; i<n; i++) {
+				if (events[i].data.fd == listen_fd) {
+					accept_connections();
+
+					continue;
+				}
+
+				auto it = connections.find(events[i].data.fd);
+				if (it == connections.end())
+					continue;
+
+				// remaining data is read before acting on a hang-up
+				if (receive(it->second) == false)
+					close_connection(it->second);
+			}
+		}
+	}
+	catch(const std::string & e) {
+		dolog(ll_error, "listener_tcp::run: an error occured: \"%s\"", e.c_str());
+	}
+
+	dolog(ll_info, "listener_tcp::run: terminating");
+
+	stop_flag = true;
+}
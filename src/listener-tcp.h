@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <map>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+
+#include "db.h"
+#include "ipfix.h"
+#include "packet-pool.h"
+
+
+// IPFIX over TCP (RFC 7011 section 10.4): one thread multiplexes all
+// exporter connections with epoll
+class listener_tcp
+{
+private:
+	struct connection {
+		int                     fd;
+		struct sockaddr_storage from;
+		// received data that does not form a complete message yet: the first
+		// 'fill' bytes; allocated once
+		std::vector<uint8_t>    data;
+		size_t                  fill;
+		// templates are scoped to the transport session
+		ipfix                  *parser;
+	};
+
+	const int               listen_fd;
+	db               *const target;
+	std::atomic_bool       &stop_flag;
+
+	int                     epoll_fd     { -1 };
+	packet_pool             pool         { 64 };
+	std::map<int, connection *> connections;
+
+	std::thread            *th           { nullptr };
+
+	void accept_connections();
+	// returns false when the connection must be closed
+	bool receive(connection *const c);
+	bool process_messages(connection *const c);
+	void close_connection(connection *const c);
+
+	void run();
+
+public:
+	// takes ownership of 'listen_fd' (see create_tcp_listen_socket), not
+	// of 'target'
+	listener_tcp(const int listen_fd, db *const target, std::atomic_bool & stop_flag);
+	virtual ~listener_tcp();
+};
@@ -1,12 +1,11 @@
 #include <atomic>
-#include <errno.h>
-#include <poll.h>
 #include <signal.h>
 #include <stdexcept>
 #include <stdio.h>
 #include <string.h>
+#include <thread>
 #include <unistd.h>
-#include <sys/socket.h>
+#include <vector>
 #include <sys/types.h>
 #include <yaml-cpp/exceptions.h>
 #include <yaml-cpp/yaml.h>
@@ -17,12 +16,21 @@
 #include "db-mongodb.h"
 #include "db-mysql.h"
 #include "db-postgres.h"
+#include "db-writer.h"
 #include "error.h"
 #include "ipfix.h"
+#include "listener-tcp.h"
 #include "logging.h"
 #include "net.h"
+#include "netflow-any.h"
 #include "netflow-v5.h"
 #include "netflow-v9.h"
+#include "packet-pool.h"
+#include "receiver-io-uring.h"
+#include "receiver-recv.h"
+#include "receiver-recvmmsg.h"
+#include "receiver-tpacket.h"
+#include "worker.h"
 #include "yaml-helpers.h"
 
 
@@ -49,7 +57,9 @@ db_field_mappings_t retrieve_mappings(const YAML::Node & cfg_storage)
 		std::string      host    = yaml_get_string(node, "field",   "name of field in the database");
 		bool             is_json = yaml_get_bool  (node, "is-json", "sets if the field is a json blob or not");
 
-		dfm.mappings.insert({ iana, { host, is_json } });
+		auto             field_id = field_lookup.get_field_id(iana);
+
+		dfm.mappings.insert({ iana, { host, is_json, field_id.has_value() ? field_id.value() : -1 } });
 	}
 
 	dfm.unmapped_fields     = yaml_get_string(cfg_storage, "unmapped-fields", "in what JSON blob to store unmapped fields, leave empty to skip");
@@ -57,6 +67,20 @@ db_field_mappings_t retrieve_mappings(const YAML::Node & cfg_storage)
 	return dfm;
 }
 
+db_sql_batching_t retrieve_batching(const YAML::Node & cfg_storage)
+{
+	db_sql_batching_t dsb;
+
+	dsb.max_rows     = yaml_get_int(cfg_storage, "batch-rows",      "maximum number of rows per INSERT", 1000);
+	dsb.max_bytes    = yaml_get_int(cfg_storage, "batch-bytes",     "maximum size of an INSERT query in bytes", 1024 * 1024);
+	dsb.max_delay_ms = yaml_get_int(cfg_storage, "batch-max-delay", "maximum number of milliseconds a row waits before it is inserted, 0 for no limit", 1000);
+
+	if (dsb.max_rows < 1)
+		error_exit(false, "batch-rows must be at least 1");
+
+	return dsb;
+}
+
 db_timeseries_aggregations_t retrieve_aggregations(const YAML::Node & cfg_storage)
 {
 	db_timeseries_aggregations_t dta;
@@ -88,7 +112,9 @@ db_timeseries_aggregations_t retrieve_aggregations(const YAML::Node & cfg_storag
 			std::string      match_key = yaml_get_string(rule_node, "match-key", "field to check");
 			std::string      match_val = yaml_get_string(rule_node, "match-val", "value to check for");
 
-			da.rules.push_back({ match_key, match_val });
+			auto             field_id  = field_lookup.get_field_id(match_key);
+
+			da.rules.push_back({ match_key, field_id.has_value() ? field_id.value() : -1, match_val });
 		}
 
 		dta.aggregations.insert({ aggregation_field, da });
@@ -97,6 +123,90 @@ db_timeseries_aggregations_t retrieve_aggregations(const YAML::Node & cfg_storag
 	return dta;
 }
 
+db *create_db(const YAML::Node & cfg_storage)
+{
+	std::string storage_type = yaml_get_string(cfg_storage, "type", "Database type to write to: 'influxdb', 'mariadb'/'mysql', 'mongodb' or 'postgres'");
+
+#if LIBMONGOCXX_FOUND == 1
+	if (storage_type == "mongodb") {
+		std::string mongodb_uri = yaml_get_string(cfg_storage, "uri", "MongoDB URI");
+		std::string mongodb_db  = yaml_get_string(cfg_storage, "db", "MongoDB database to write to");
+		std::string mongodb_collection = yaml_get_string(cfg_storage, "collection", "collection to write to");
+
+		db_field_mappings_t dfm = retrieve_mappings(cfg_storage);
+
+		return new db_mongodb(mongodb_uri, mongodb_db, mongodb_collection, dfm);
+	}
+#endif
+#if POSTGRES_FOUND == 1
+	if (storage_type == "postgres") {
+		std::string         connection_info = yaml_get_string(cfg_storage, "connection-info", "Postgres connection info string");
+
+		db_field_mappings_t dfm = retrieve_mappings(cfg_storage);
+		db_sql_batching_t   dsb = retrieve_batching(cfg_storage);
+
+		std::string         write_mode = yaml_get_string(cfg_storage, "write-mode", "\"copy\" (COPY in binary format), \"pipeline\" (a prepared INSERT per row, libpq pipeline mode) or \"insert\" (multi-row INSERTs)", "copy");
+		postgres_write_mode_t pwm      = pwm_copy;
+
+		if (write_mode == "insert")
+			pwm = pwm_insert;
+		else if (write_mode == "pipeline") {
+#ifndef LIBPQ_HAS_PIPELINING
+			error_exit(false, "write-mode \"pipeline\" requires libpq 14 or newer");
+#endif
+			pwm = pwm_pipeline;
+		}
+		else if (write_mode != "copy")
+			error_exit(false, "write-mode \"%s\" not recognized", write_mode.c_str());
+
+		return new db_postgres(connection_info, dfm, dsb, pwm);
+	}
+#endif
+#if MARIADB_FOUND == 1
+	if (storage_type == "mariadb" || storage_type == "mysql") {
+		std::string         host   = yaml_get_string(cfg_storage, "host", "MariaDB host to connect to");
+		std::string         user   = yaml_get_string(cfg_storage, "user", "username to authenticate with");
+		std::string         pass   = yaml_get_string(cfg_storage, "pass", "passwor to authenticate with");
+		std::string         dbname = yaml_get_string(cfg_storage, "db",   "database to write to");
+
+		db_field_mappings_t dfm    = retrieve_mappings(cfg_storage);
+		db_sql_batching_t   dsb    = retrieve_batching(cfg_storage);
+
+		bool                bulk    = yaml_get_bool(cfg_storage, "bulk-insert",    "write batches with array binding when the server (MariaDB 10.2.6 or later) supports it", true);
+		int                 ld_rows = yaml_get_int (cfg_storage, "load-data-rows", "batches of at least this many rows are sent with LOAD DATA LOCAL INFILE (with bulk-insert), 0 to never", 0);
+
+		return new db_mysql(host, user, pass, dbname, dfm, dsb, bulk, ld_rows);
+	}
+#endif
+	if (storage_type == "influxdb") {
+		std::string host   = yaml_get_string(cfg_storage, "host", "InfluxDB host to connect to");
+		int         port   = yaml_get_int   (cfg_storage, "port", "InfluxDB port to connect to");
+
+		db_timeseries_aggregations_t dta = retrieve_aggregations(cfg_storage);
+
+		return new db_influxdb(host, port, dta);
+	}
+
+	error_exit(false, "Database \"%s\" not supported/understood", storage_type.c_str());
+}
+
+ipfix *create_parser(const std::string & protocol)
+{
+	if (protocol == "ipfix")
+		return new ipfix();
+
+	if (protocol == "v9")
+		return new netflow_v9();
+
+	if (protocol == "v5")
+		return new netflow_v5();
+
+	if (protocol == "auto")
+		return new netflow_any();
+
+	error_exit(false, "Protocol \"%s\" not supported/understood", protocol.c_str());
+}
+
 void help()
 {
 	printf("-c file  load configuration from 'file'\n");
@@ -129,8 +239,6 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	db *db = nullptr;
-
 	YAML::Node config;
 
 	try {
@@ -152,116 +260,218 @@ int main(int argc, char *argv[])
 
 		setlog(logfile.c_str(), ll_file, ll_screen);
 
+		// information elements that are not in the IANA registry
+		std::string enterprise_dictionary = yaml_get_string(config, "enterprise-dictionary", "file with enterprise specific information elements", "");
+
+		if (enterprise_dictionary.empty() == false && field_lookup.load_enterprise_dictionary(enterprise_dictionary) == false)
+			error_exit(false, "Cannot load enterprise dictionary \"%s\"", enterprise_dictionary.c_str());
+
 		// select target
 		YAML::Node cfg_storage = config["storage"];
-		std::string storage_type = yaml_get_string(cfg_storage, "type", "Database type to write to: 'influxdb', 'mariadb'/'mysql', 'mongodb' or 'postgres'");
 
-#if LIBMONGOCXX_FOUND == 1
-		if (storage_type == "mongodb") {
-			std::string mongodb_uri = yaml_get_string(cfg_storage, "uri", "MongoDB URI");
-			std::string mongodb_db  = yaml_get_string(cfg_storage, "db", "MongoDB database to write to");
-			std::string mongodb_collection = yaml_get_string(cfg_storage, "collection", "collection to write to");
+		// ports to listen on, each with the protocol to accept; they share the
+		// workers and database connections
+		std::vector<std::pair<int, std::string> > listeners;
 
-			db_field_mappings_t dfm = retrieve_mappings(cfg_storage);
+		if (config["listeners"]) {
+			YAML::Node cfg_listeners = config["listeners"];
+			for(YAML::const_iterator it = cfg_listeners.begin(); it != cfg_listeners.end(); it++) {
+				const YAML::Node node     = it->as<YAML::Node>();
 
-			db = new db_mongodb(mongodb_uri, mongodb_db, mongodb_collection, dfm);
-		}
-		else
-#endif
-#if POSTGRES_FOUND == 1
-		if (storage_type == "postgres") {
-			std::string         connection_info = yaml_get_string(cfg_storage, "connection-info", "Postgres connection info string");
+				int              port     = yaml_get_int   (node, "port",     "UDP port to listen on");
+				std::string      protocol = yaml_get_string(node, "protocol", "protocol to accept; \"ipfix\", \"v5\", \"v9\" (v5/v9 are NetFlow) or \"auto\" (all three)");
 
-			db_field_mappings_t dfm = retrieve_mappings(cfg_storage);
+				listeners.push_back({ port, protocol });
+			}
+		}
+		else {
+			int         listen_port = yaml_get_int   (config, "listen-port", "UDP port to listen on");
+			std::string protocol    = yaml_get_string(config, "protocol", "protocol to accept; \"ipfix\", \"v5\", \"v9\" (v5/v9 are NetFlow) or \"auto\" (all three)");
 
-			db = new db_postgres(connection_info, dfm);
+			listeners.push_back({ listen_port, protocol });
 		}
-		else
+
+		if (listeners.empty())
+			error_exit(false, "No listeners configured");
+
+		for(auto & l : listeners)
+			delete create_parser(l.second);  // validates the protocol
+		// exporters that send IPFIX over TCP (RFC 7011); 0 to disable
+		int         tcp_port    = yaml_get_int   (config, "tcp-listen-port", "TCP port to accept IPFIX connections on", 0);
+
+		// each worker has its own socket, parser (template state) and database connection
+		int         n_workers   = yaml_get_int   (config, "workers", "number of receive/process threads", 1);
+		bool        cpu_pinning = yaml_get_bool  (config, "cpu-pinning", "pin each worker to its own cpu", false);
+		// decouples receiving from (slow) parsing/storing
+		int         queue_size  = yaml_get_int   (config, "queue-size", "number of datagrams buffered between receive- and parse-thread, 0 for no separate receive thread", 0);
+
+		if (n_workers < 1)
+			error_exit(false, "workers must be at least 1");
+
+		// how datagrams are retrieved from the kernel
+		std::string receive_mode = yaml_get_string(config, "receive-mode", "\"recv\" (one datagram per system call), \"recvmmsg\" (batched), \"io_uring\" or \"capture\"", "recv");
+		int         batch_size   = yaml_get_int   (config, "receive-batch-size", "maximum number of datagrams per recvmmsg call", 32);
+		bool        udp_gro      = yaml_get_bool  (config, "udp-gro", "let the kernel coalesce datagrams (recvmmsg only)", false);
+		int         n_buffers    = yaml_get_int   (config, "io-uring-buffers", "number of 64 kB buffers registered with io_uring (power of 2)", 256);
+		bool        latency_mode = yaml_get_bool  (config, "latency-mode", "busy-poll socket and io_uring (io_uring only)", false);
+		std::string capture_dev  = yaml_get_string(config, "capture-interface", "network interface to capture exports from (capture only)", "");
+		int         n_blocks     = yaml_get_int   (config, "capture-blocks", "number of 1 MB blocks in the capture ring (capture only)", 64);
+
+		// kernel side socket buffering; growing stops at the maximum (0 = fixed size)
+		int         rcvbuf_size  = yaml_get_int   (config, "receive-buffer", "socket receive buffer size in bytes, 0 for the system default", 0);
+		int         rcvbuf_max   = yaml_get_int   (config, "receive-buffer-max", "grow the receive buffer up to this size when the kernel drops datagrams, 0 to disable", 0);
+
+		if (receive_mode == "capture" && capture_dev.empty())
+			error_exit(false, "capture-interface must be set for receive-mode \"capture\"");
+
+		if (receive_mode != "recv" && receive_mode != "recvmmsg" && receive_mode != "capture"
+#if IO_URING_FOUND == 1
+				&& receive_mode != "io_uring"
 #endif
-#if MARIADB_FOUND == 1
-		if (storage_type == "mariadb" || storage_type == "mysql") {
-			std::string         host   = yaml_get_string(cfg_storage, "host", "MariaDB host to connect to");
-			std::string         user   = yaml_get_string(cfg_storage, "user", "username to authenticate with");
-			std::string         pass   = yaml_get_string(cfg_storage, "pass", "passwor to authenticate with");
-			std::string         dbname = yaml_get_string(cfg_storage, "db",   "database to write to");
+				)
+			error_exit(false, "Receive mode \"%s\" not supported/understood", receive_mode.c_str());
 
-			db_field_mappings_t dfm    = retrieve_mappings(cfg_storage);
+		if (batch_size < 1)
+			error_exit(false, "receive-batch-size must be at least 1");
 
-			db = new db_mysql(host, user, pass, dbname, dfm);
-		}
-		else
-#endif
-		if (storage_type == "influxdb") {
-			std::string host   = yaml_get_string(cfg_storage, "host", "InfluxDB host to connect to");
-			int         port   = yaml_get_int   (cfg_storage, "port", "InfluxDB port to connect to");
+		// optional stage between parsers and storage, with its own threads and
+		// connections
+		int         n_writers    = yaml_get_int   (cfg_storage, "writers", "number of threads (each with a database connection, unless the storage is thread safe) that store records asynchronously, 0 to store them in the workers", 0);
+		int         writer_queue = yaml_get_int   (cfg_storage, "writer-queue-size", "number of records that can wait for a writer (about 1 kB each, per queue)", 16384);
+		bool        writer_order = yaml_get_bool  (cfg_storage, "writer-ordered", "store the records of an observation domain (per exporter) in the order they were received", false);
+
+		if (n_writers < 0 || writer_queue < 1)
+			error_exit(false, "writers must be 0 or more, writer-queue-size at least 1");
+
+		std::vector<db *> dbs;
+
+		if (n_writers > 0) {
+			std::vector<db *> targets { create_db(cfg_storage) };
 
-			db_timeseries_aggregations_t dta = retrieve_aggregations(cfg_storage);
+			// a thread safe target is shared by the writers: e.g. influxdb
+			// aggregates in-process, a second instance would emit a part of
+			// the totals
+			for(int nr=1; nr<n_writers; nr++)
+				targets.push_back(targets.at(0)->is_thread_safe() ? targets.at(0) : create_db(cfg_storage));
 
-			db = new db_influxdb(host, port, dta);
+			dbs.push_back(new db_writer(targets, writer_queue, writer_order));
 		}
-		else
-		{
-			error_exit(false, "Database \"%s\" not supported/understood", storage_type.c_str());
+		else {
+			dbs.push_back(create_db(cfg_storage));
 		}
 
-		db->init_database();
+		dbs.at(0)->init_database();
 
-		// port to listen on
-		int         listen_port = yaml_get_int   (config, "listen-port", "UDP port to listen on");
-		std::string protocol    = yaml_get_string(config, "protocol", "protocol to accept; \"ipfix\", \"v5\" or \"v9\" (v5/v9 are NetFlow)");
+		if (dbs.at(0)->is_thread_safe() == false) {
+			for(int nr=1; nr<n_workers; nr++)
+				dbs.push_back(create_db(cfg_storage));
+		}
 
-		ipfix *i = nullptr;
+		// per listener, a socket for each worker
+		std::vector<std::vector<int> > fds(listeners.size());
 
-		if (protocol == "ipfix")
-			i = new ipfix();
-		else if (protocol == "v9")
-			i = new netflow_v9();
-		else if (protocol == "v5")
-			i = new netflow_v5();
-		else
-			error_exit(false, "Protocol \"%s\" not supported/understood", protocol.c_str());
+		for(size_t l=0; l<listeners.size(); l++) {
+			int listen_port = listeners.at(l).first;
 
-		dolog(ll_debug, "main: will listen on port %d", listen_port);
+			dolog(ll_debug, "main: will listen on port %d (%s) with %d worker(s)", listen_port, listeners.at(l).second.c_str(), n_workers);
 
-		int fd = create_udp_listen_socket(listen_port);
-		if (fd == -1)
-			error_exit(true, "Cannot create UDP listening socket on port %d", listen_port);
+			// capturing bypasses the socket layer
+			if (receive_mode == "capture")
+				continue;
+
+			for(int nr=0; nr<n_workers; nr++) {
+				int fd = create_udp_listen_socket(listen_port, n_workers > 1, rcvbuf_size);
+				if (fd == -1)
+					error_exit(true, "Cannot create UDP listening socket on port %d", listen_port);
+
+				fds.at(l).push_back(fd);
+			}
+
+			if (n_workers > 1 && attach_reuseport_steering(fds.at(l).at(0), n_workers) == false)
+				error_exit(false, "Cannot attach exporter steering program to UDP socket");
+		}
+
+		int tcp_fd = -1;
+
+		if (tcp_port > 0) {
+			tcp_fd = create_tcp_listen_socket(tcp_port);
+			if (tcp_fd == -1)
+				error_exit(true, "Cannot create TCP listening socket on port %d", tcp_port);
+		}
 
 		if (do_fork) {
 			if (daemon(-1, -1) == -1)
 				error_exit(true, "main: can't become daemon process");
 		}
 
-		struct pollfd fds[] { { fd, POLLIN, 0 } };
+		int n_cpus = std::thread::hardware_concurrency();
 
-		while(!stop_flag) {
-			int rcp = poll(fds, 1, 500);
+		std::vector<worker *>      workers;
+		std::vector<packet_pool *> pools;
 
-			if (rcp == 0)  // timeout
-				continue;
+		for(int nr=0; nr<n_workers; nr++) {
+			int cpu = cpu_pinning && n_cpus > 0 ? nr % n_cpus : -1;
+
+			packet_pool *pool = new packet_pool(batch_size * 2);
+			pools.push_back(pool);
+
+			db                     *target = dbs.at(nr % dbs.size());
+
+			std::vector<receiver *> receivers;
+			std::vector<ipfix *>    parsers;
+
+			for(size_t l=0; l<listeners.size(); l++) {
+				receiver *r = nullptr;
 
-			if (rcp == -1) {
-				dolog(ll_error, "main: problem polling for UDP packets: %s", strerror(errno));
-				break;
+				if (receive_mode == "recvmmsg")
+					r = new receiver_recvmmsg(fds.at(l).at(nr), batch_size, udp_gro, pool);
+				else if (receive_mode == "capture")  // a fanout group per listener
+					r = new receiver_tpacket(capture_dev, listeners.at(l).first, n_blocks, n_workers > 1 ? getpid() + l : 0);
+#if IO_URING_FOUND == 1
+				else if (receive_mode == "io_uring")
+					r = new receiver_io_uring(fds.at(l).at(nr), n_buffers, latency_mode);
+#endif
+				else
+					r = new receiver_recv(fds.at(l).at(nr), pool);
+
+				r->set_receive_buffer_max(rcvbuf_max);
+
+				receivers.push_back(r);
+				ipfix *parser = create_parser(listeners.at(l).second);
+				parser->set_projection(target->get_projection());
+
+				parsers.push_back(parser);
 			}
 
-			uint8_t buffer[65527] { 0 };
-			int rrc = recv(fd, buffer, sizeof buffer, 0);
+			workers.push_back(new worker(nr, receivers, parsers, target, cpu, queue_size, pool, stop_flag));
+		}
+
+		listener_tcp *tcp = nullptr;
 
-			if (rrc == -1) {
-				dolog(ll_error, "main: problem receiving UDP packet: %s", strerror(errno));
-				continue;
+		if (tcp_fd != -1) {
+			db *target = dbs.at(0);
+
+			if (target->is_thread_safe() == false) {
+				target = create_db(cfg_storage);
+				dbs.push_back(target);
 			}
 
-			if (i->process_packet(buffer, rrc, db) == false)
-				dolog(ll_error, "main: problem processing ipfix packet");
+			tcp = new listener_tcp(tcp_fd, target, stop_flag);
 		}
 
-		close(fd);
+		while(!stop_flag)
+			usleep(100000);
+
+		delete tcp;
+
+		for(auto w : workers)
+			delete w;
 
-		delete i;
+		for(auto db : dbs)
+			delete db;
 
-		delete db;
+		for(auto pool : pools)
+			delete pool;
 	}
 	catch(const std::out_of_range & e) {
 		dolog(ll_error, "main: 'out of range' exception (%s); internal error", e.what());
@@ -0,0 +1,109 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+
+// bounded multi-producer/multi-consumer queue; producers wait while it is
+// full (back pressure), consumers take what there is in one go (one lock
+// per batch). slots are re-used.
+template <typename T>
+class mpmc_queue
+{
+private:
+	std::vector<T>          slots;
+	const size_t            size;
+
+	std::mutex              lock;
+	std::condition_variable not_empty;
+	std::condition_variable not_full;
+	size_t                  head            { 0 };
+	size_t                  n               { 0 };
+	bool                    stopped         { false };
+
+	size_t                  high_water_mark { 0 };
+	uint64_t                n_full_waits    { 0 };
+
+public:
+	mpmc_queue(const size_t size) : slots(size), size(size)
+	{
+	}
+
+	virtual ~mpmc_queue()
+	{
+	}
+
+	// producer: moves all of 'items' in; false when stop() was invoked
+	bool push(T *const items, const size_t n_items)
+	{
+		std::unique_lock<std::mutex> lck(lock);
+
+		for(size_t i=0; i<n_items; i++) {
+			if (n == size) {
+				n_full_waits++;
+
+				not_empty.notify_all();
+				not_full.wait(lck, [this] { return n < size || stopped; });
+			}
+
+			if (stopped)
+				return false;
+
+			slots[(head + n) % size] = std::move(items[i]);
+			n++;
+		}
+
+		high_water_mark = std::max(high_water_mark, n);
+
+		lck.unlock();
+
+		not_empty.notify_one();
+
+		return true;
+	}
+
+	// consumer: moves at most 'max_items' to 'out', waits at most
+	// 'timeout_ms' when there is nothing; returns the number of items
+	size_t pop(std::vector<T> *const out, const size_t max_items, const int timeout_ms)
+	{
+		std::unique_lock<std::mutex> lck(lock);
+
+		if (n == 0)
+			not_empty.wait_for(lck, std::chrono::milliseconds(timeout_ms), [this] { return n > 0 || stopped; });
+
+		size_t count = std::min(n, max_items);
+
+		for(size_t i=0; i<count; i++) {
+			out->push_back(std::move(slots[head]));
+
+			head = (head + 1) % size;
+		}
+
+		n -= count;
+
+		lck.unlock();
+
+		if (count)
+			not_full.notify_all();
+
+		return count;
+	}
+
+	// wakes up everyone; push() fails from now on, pop() returns what is left
+	void stop()
+	{
+		std::unique_lock<std::mutex> lck(lock);
+
+		stopped = true;
+
+		not_empty.notify_all();
+		not_full .notify_all();
+	}
+
+	size_t   get_size()            const { return size; }
+	size_t   get_high_water_mark()       { std::unique_lock<std::mutex> lck(lock); return high_water_mark; }
+	uint64_t get_n_full_waits()          { std::unique_lock<std::mutex> lck(lock); return n_full_waits;    }
+};
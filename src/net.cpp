@@ -1,7 +1,9 @@
+#include <endian.h>
 #include <errno.h>
 #include <netdb.h>
 #include <string.h>
 #include <unistd.h>
+#include <linux/filter.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
 #include <sys/socket.h>
@@ -10,7 +12,34 @@
 #include "logging.h"
 
 
-int create_udp_listen_socket(const int port)
+int get_receive_buffer_size(const int fd)
+{
+	int       size = 0;
+	socklen_t len  = sizeof size;
+
+	if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, &len) == -1) {
+		dolog(ll_error, "get_receive_buffer_size: cannot retrieve receive buffer size of socket %d: %s", fd, strerror(errno));
+		return -1;
+	}
+
+	// the kernel doubles the requested size for its bookkeeping
+	return size / 2;
+}
+
+int set_receive_buffer_size(const int fd, const int size)
+{
+	// SO_RCVBUFFORCE is not limited by net.core.rmem_max but requires CAP_NET_ADMIN
+	if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof size) == -1) {
+		if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof size) == -1) {
+			dolog(ll_error, "set_receive_buffer_size: cannot set receive buffer of socket %d to %d bytes: %s", fd, size, strerror(errno));
+			return -1;
+		}
+	}
+
+	return get_receive_buffer_size(fd);
+}
+
+int create_udp_listen_socket(const int port, const bool reuse_port, const int receive_buffer_size)
 {
 	int fd = socket(AF_INET, SOCK_DGRAM, 0);
 	if (fd == -1) {
@@ -20,6 +49,40 @@ int create_udp_listen_socket(const int port)
 
 	dolog(ll_debug, "create_udp_listen_socket: created socket %d", fd);
 
+        int reuse_addr = 1;
+	if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char *)&reuse_addr, sizeof(reuse_addr)) == -1) {
+		dolog(ll_error, "create_udp_listen_socket: cannot set socket %d to 're-use address': %s", fd, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	// must be set before bind() for the kernel to add this socket to the port-group
+	if (reuse_port) {
+		int reuse_port_value = 1;
+		if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &reuse_port_value, sizeof(reuse_port_value)) == -1) {
+			dolog(ll_error, "create_udp_listen_socket: cannot set socket %d to 're-use port': %s", fd, strerror(errno));
+			close(fd);
+			return -1;
+		}
+	}
+
+	if (receive_buffer_size > 0) {
+		int effective_size = set_receive_buffer_size(fd, receive_buffer_size);
+
+		if (effective_size == -1) {
+			close(fd);
+			return -1;
+		}
+
+		if (effective_size < receive_buffer_size)
+			dolog(ll_info, "create_udp_listen_socket: receive buffer of socket %d is %d bytes instead of %d (not root? see net.core.rmem_max)", fd, effective_size, receive_buffer_size);
+	}
+
+	// let the kernel report how many datagrams it dropped for this socket
+	int on = 1;
+	if (setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof on) == -1)
+		dolog(ll_warning, "create_udp_listen_socket: cannot enable drop counter on socket %d: %s", fd, strerror(errno));
+
 	struct sockaddr_in bind_i { 0 };
 
 	bind_i.sin_family      = AF_INET;
@@ -33,9 +96,40 @@ int create_udp_listen_socket(const int port)
 		return -1;
 	}
 
-        int reuse_addr = 1;
-	if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char *)&reuse_addr, sizeof(reuse_addr)) == -1) {
-		dolog(ll_error, "create_udp_listen_socket: cannot set socket %d to 're-use address': %s", fd, strerror(errno));
+	return fd;
+}
+
+int create_tcp_listen_socket(const int port)
+{
+	int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	if (fd == -1) {
+		dolog(ll_error, "create_tcp_listen_socket: cannot create socket: %s", strerror(errno));
+		return -1;
+	}
+
+	dolog(ll_debug, "create_tcp_listen_socket: created socket %d", fd);
+
+	int reuse_addr = 1;
+	if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse_addr, sizeof(reuse_addr)) == -1) {
+		dolog(ll_error, "create_tcp_listen_socket: cannot set socket %d to 're-use address': %s", fd, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	struct sockaddr_in bind_i { 0 };
+
+	bind_i.sin_family      = AF_INET;
+	bind_i.sin_port        = htons(port);
+	bind_i.sin_addr.s_addr = INADDR_ANY;
+
+	if (bind(fd, reinterpret_cast<const sockaddr *>(&bind_i), sizeof bind_i) == -1) {
+		dolog(ll_error, "create_tcp_listen_socket: cannot bind socket %d to port %d: %s", fd, port, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	if (listen(fd, SOMAXCONN) == -1) {
+		dolog(ll_error, "create_tcp_listen_socket: cannot listen on socket %d: %s", fd, strerror(errno));
 		close(fd);
 		return -1;
 	}
@@ -43,26 +137,72 @@ int create_udp_listen_socket(const int port)
 	return fd;
 }
 
+bool attach_reuseport_steering(const int fd, const int n_sockets)
+{
+	// the index returned selects the socket in the order in which they were
+	// bound to the port; hashing on the source address keeps every exporter on
+	// the same socket (and thus on the same template state)
+	struct sock_filter code[] {
+		{ BPF_LD  | BPF_W | BPF_ABS, 0, 0, uint32_t(SKF_NET_OFF + 12) },  // A = IPv4 source address
+		{ BPF_ALU | BPF_MOD | BPF_K, 0, 0, uint32_t(n_sockets)        },  // A %= n_sockets
+		{ BPF_RET | BPF_A,           0, 0, 0                           },
+	};
+
+	struct sock_fprog program { sizeof(code) / sizeof(code[0]), code };
+
+	if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof program) == -1) {
+		dolog(ll_error, "attach_reuseport_steering: cannot attach steering program to socket %d: %s", fd, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
 uint16_t get_net_short(const uint8_t *const p)
 {
-	return (p[0] << 8) | p[1];
+	uint16_t v;
+	memcpy(&v, p, sizeof v);
+
+	return be16toh(v);
 }
 
 uint32_t get_net_long(const uint8_t *const p)
 {
-	return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+	uint32_t v;
+	memcpy(&v, p, sizeof v);
+
+	return be32toh(v);
 }
 
 uint64_t get_net_long_long(const uint8_t *const p)
 {
-	uint64_t out = 0;
+	uint64_t v;
+	memcpy(&v, p, sizeof v);
 
-	for(int i=0; i<8; i++) {
-		out <<= 8;
-		out |= p[i];
+	return be64toh(v);
+}
+
+// FNV-1a
+uint64_t hash_address(const sockaddr_storage & a)
+{
+	const uint8_t *p   = nullptr;
+	int            len = 0;
+
+	if (a.ss_family == AF_INET) {
+		p   = reinterpret_cast<const uint8_t *>(&reinterpret_cast<const sockaddr_in *>(&a)->sin_addr);
+		len = 4;
+	}
+	else if (a.ss_family == AF_INET6) {
+		p   = reinterpret_cast<const uint8_t *>(&reinterpret_cast<const sockaddr_in6 *>(&a)->sin6_addr);
+		len = 16;
 	}
 
-	return out;
+	uint64_t h = len ? 14695981039346656037ull : 0;
+
+	for(int i=0; i<len; i++)
+		h = (h ^ p[i]) * 1099511628211ull;
+
+	return h;
 }
 
 int connect_to(const std::string & host, const int portnr)
@@ -1,12 +1,23 @@
 #include <stdint.h>
+#include <sys/socket.h>
 
 
-int create_udp_listen_socket(const int port);
+// receive_buffer_size: 0 for the system default
+int create_udp_listen_socket(const int port, const bool reuse_port, const int receive_buffer_size);
+// both return the effective size or -1 on error
+int get_receive_buffer_size(const int fd);
+int set_receive_buffer_size(const int fd, const int size);
+// non-blocking
+int create_tcp_listen_socket(const int port);
+bool attach_reuseport_steering(const int fd, const int n_sockets);
 
 uint16_t get_net_short(const uint8_t *const p);
 uint32_t get_net_long(const uint8_t *const p);
 uint64_t get_net_long_long(const uint8_t *const p);
 
+// of the address only (not the port); 0 for other families
+uint64_t hash_address(const sockaddr_storage & a);
+
 int connect_to(const std::string & host, const int portnr);
 
 ssize_t WRITE(int fd, const uint8_t *whereto, size_t len);
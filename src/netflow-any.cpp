@@ -0,0 +1,43 @@
+#include "logging.h"
+#include "net.h"
+#include "netflow-any.h"
+
+
+netflow_any::netflow_any()
+{
+}
+
+netflow_any::~netflow_any()
+{
+}
+
+void netflow_any::set_projection(const std::optional<field_projection_t> & projection)
+{
+	parser_ipfix.set_projection(projection);
+	parser_v9   .set_projection(projection);
+	parser_v5   .set_projection(projection);
+}
+
+bool netflow_any::process_packet(const packet_t & packet, db *const target)
+{
+	if (packet.len < 2) {
+		dolog(ll_warning, "netflow_any::process_packet: packet too short (%d bytes)", packet.len);
+
+		return false;
+	}
+
+	uint16_t version_number = get_net_short(packet.data);
+
+	if (version_number == 10)
+		return parser_ipfix.process_packet(packet, target);
+
+	if (version_number == 9)
+		return parser_v9.process_packet(packet, target);
+
+	if (version_number == 5)
+		return parser_v5.process_packet(packet, target);
+
+	dolog(ll_warning, "netflow_any::process_packet: version %d not supported", version_number);
+
+	return false;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+
+#include "db.h"
+#include "ipfix.h"
+#include "netflow-v5.h"
+#include "netflow-v9.h"
+
+
+// accepts IPFIX, NetFlow v9 and v5 on the same socket: dispatches on the
+// version field every one of them starts with
+class netflow_any : public ipfix
+{
+private:
+	ipfix      parser_ipfix;
+	netflow_v9 parser_v9;
+	netflow_v5 parser_v5;
+
+public:
+	netflow_any();
+	virtual ~netflow_any();
+
+	void set_projection(const std::optional<field_projection_t> & projection) override;
+
+	bool process_packet(const packet_t & packet, db *const target) override;
+};
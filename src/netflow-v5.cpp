@@ -1,28 +1,87 @@
+#include <iterator>
 #include <time.h>
+#include <vector>
 
 #include "buffer.h"
 #include "netflow-v5.h"
 #include "logging.h"
 #include "net.h"
-#include "str.h"
 
 
+constexpr int v5_header_length = 24;
+constexpr int v5_record_length = 48;
+constexpr int v5_max_count     = 30;
+
+constexpr uint16_t paddingOctets = 210;
+
+// the IANA equivalent of each field of a flow record, in wire order
+static const information_element_t v5_record[] {
+	{ false, 8,             4, 0 },  // sourceIPv4Address
+	{ false, 12,            4, 0 },  // destinationIPv4Address
+	{ false, 15,            4, 0 },  // ipNextHopIPv4Address
+	{ false, 10,            2, 0 },  // ingressInterface: SNMP index of input interface
+	{ false, 14,            2, 0 },  // egressInterface: SNMP index of output interface
+	{ false, 2,             4, 0 },  // packetDeltaCount: number of packets in this flow
+	{ false, 1,             4, 0 },  // octetDeltaCount: number of bytes in this flow
+	{ false, 22,            4, 0 },  // flowStartSysUpTime: system uptime of first packet in this flow
+	{ false, 21,            4, 0 },  // flowEndSysUpTime: system uptime of last packet in this flow
+	{ false, 7,             2, 0 },  // sourceTransportPort
+	{ false, 11,            2, 0 },  // destinationTransportPort
+	{ false, paddingOctets, 1, 0 },  // pad1 (unused)
+	{ false, 6,             1, 0 },  // tcpControlBits: TCP flags (ORed)
+	{ false, 4,             1, 0 },  // protocolIdentifier: IP protocol (TCP, UDP)
+	{ false, 5,             1, 0 },  // ipClassOfService: type of service
+	{ false, 16,            2, 0 },  // bgpSourceAsNumber: "Autonomous system number of the source, either origin or peer"
+	{ false, 17,            2, 0 },  // bgpDestinationAsNumber: "Autonomous system number of the destination, either origin or peer"
+	{ false, 9,             1, 0 },  // sourceIPv4PrefixLength: source address prefix mask bits
+	{ false, 13,            1, 0 },  // destinationIPv4PrefixLength: destination address prefix mask bits
+	{ false, paddingOctets, 2, 0 },  // pad2 (unused)
+};
+
 netflow_v5::netflow_v5()
 {
+	compile_plan();
 }
 
 netflow_v5::~netflow_v5()
 {
 }
 
-bool netflow_v5::process_packet(const uint8_t *const packet, const int packet_size, db *const target)
+void netflow_v5::compile_plan()
 {
-	buffer b(packet, packet_size);
+	// the padding is never stored
+	field_projection_t v5_projection = projection.has_value() ? projection.value() : field_projection_t().set();
+	v5_projection.reset(paddingOctets);
+
+	plan = compile_decode_plan(std::vector<information_element_t>(std::begin(v5_record), std::end(v5_record)), &v5_projection);
 
-	dolog(ll_debug, "process_netflow_v5_packet: packet size          : %d", packet_size);
+	if (plan.record_length != v5_record_length)
+		dolog(ll_error, "netflow_v5::compile_plan: record length is %d bytes instead of %d", plan.record_length, v5_record_length);
+}
+
+void netflow_v5::set_projection(const std::optional<field_projection_t> & projection)
+{
+	ipfix::set_projection(projection);
+
+	compile_plan();
+}
+
+// the records have a fixed layout: the count is checked once against the
+// length of the datagram, then all records are decoded into one batch
+bool netflow_v5::process_packet(const packet_t & packet, db *const target)
+{
+	buffer_view b(packet.data, packet.len);
+
+	dolog(ll_debug, "process_netflow_v5_packet: packet size          : %d", packet.len);
+
+	if (b.has(v5_header_length) == false) {
+		dolog(ll_warning, "process_netflow_v5_packet: packet too short for header (%d bytes)", packet.len);
+
+		return false;
+	}
 
 	// message header
-	uint16_t version_number  = b.get_net_short();
+	uint16_t version_number  = b.get_net_short_unchecked();
 
 	if (version_number != 5) {
 		dolog(ll_warning, "process_netflow_v5_packet: not a version 5 packet (%d instead)", version_number);
@@ -30,14 +89,14 @@ bool netflow_v5::process_packet(const uint8_t *const packet, const int packet_si
 		return false;
 	}
 
-	uint16_t count             = b.get_net_short();
-	uint32_t sysuptime         = b.get_net_long ();
-	time_t   unix_secs         = b.get_net_long ();
-	uint32_t unix_nsecs        = b.get_net_long ();
-	uint32_t flow_sequence     = b.get_net_long ();
-	uint8_t  engine_type       = b.get_byte     ();
-	uint8_t  engine_id         = b.get_byte     ();
-	uint16_t sampling_interval = b.get_net_short();
+	uint16_t count             = b.get_net_short_unchecked();
+	uint32_t sysuptime         = b.get_net_long_unchecked ();
+	time_t   unix_secs         = b.get_net_long_unchecked ();
+	uint32_t unix_nsecs        = b.get_net_long_unchecked ();
+	uint32_t flow_sequence     = b.get_net_long_unchecked ();
+	uint8_t  engine_type       = b.get_byte_unchecked     ();
+	uint8_t  engine_id         = b.get_byte_unchecked     ();
+	uint16_t sampling_interval = b.get_net_short_unchecked();
 
 	dolog(ll_debug, "process_netflow_v5_packet: version number   : %d", version_number);
 	dolog(ll_debug, "process_netflow_v5_packet: count            : %d", count);
@@ -49,73 +108,32 @@ bool netflow_v5::process_packet(const uint8_t *const packet, const int packet_si
 	dolog(ll_debug, "process_netflow_v5_packet: engine id        : %d", engine_id);
 	dolog(ll_debug, "process_netflow_v5_packet: sampling interval: %d", sampling_interval);
 
-	while(b.end_reached() == false) {
-		db_record_t dr { 0 };
-		dr.export_time           = unix_secs;
-		dr.sequence_number       = flow_sequence;
-		dr.observation_domain_id = engine_id;
-
-		db_record_data_t sourceIPv4Address { b.get_segment(4), dt_ipv4Address, 4 };       // source IP address
-		dr.data.insert({ "sourceIPv4Address", sourceIPv4Address });
-
-		db_record_data_t destinationIPv4Address { b.get_segment(4), dt_ipv4Address, 4 };  // destinationIPv4Address IP address
-		dr.data.insert({ "destinationIPv4Address", destinationIPv4Address });
-
-		db_record_data_t ipNextHopIPv4Address { b.get_segment(4), dt_ipv4Address, 4 };    // ipNextHopIPv4Address IP address
-		dr.data.insert({ "ipNextHopIPv4Address", ipNextHopIPv4Address });
+	if (count > v5_max_count) {
+		dolog(ll_warning, "process_netflow_v5_packet: count %d invalid (at most %d)", count, v5_max_count);
 
-		db_record_data_t ingressInterface { b.get_segment(2), dt_unsigned32, 2 };         // SNMP index of input interface
-		dr.data.insert({ "ingressInterface", ingressInterface });
-
-		db_record_data_t egressInterface { b.get_segment(2), dt_unsigned32, 2 };          // SNMP index of output interface
-		dr.data.insert({ "egressInterface", egressInterface });
-
-		db_record_data_t packetDeltaCount { b.get_segment(4), dt_unsigned64, 4 };         // number of packets in this flow
-		dr.data.insert({ "packetDeltaCount", packetDeltaCount });
-
-		db_record_data_t octetDeltaCount { b.get_segment(4), dt_unsigned64, 4 };          // number of bytes in this flow
-		dr.data.insert({ "octetDeltaCount", octetDeltaCount });
-
-		db_record_data_t flowStartSysUpTime { b.get_segment(4), dt_unsigned32, 4 };       // system uptime of first packet in this flow
-		dr.data.insert({ "flowStartSysUpTime", flowStartSysUpTime });
-
-		db_record_data_t flowEndSysUpTime { b.get_segment(4), dt_unsigned32, 4 };        // system uptime of last packet in this flow
-		dr.data.insert({ "flowEndSysUpTime", flowEndSysUpTime });
-
-		db_record_data_t sourceTransportPort { b.get_segment(2), dt_unsigned16, 2 };      // source port
-		dr.data.insert({ "sourceTransportPort", sourceTransportPort });
-
-		db_record_data_t destinationTransportPort { b.get_segment(2), dt_unsigned16, 2 }; // destination port
-		dr.data.insert({ "destinationTransportPort", destinationTransportPort });
-
-		b.get_byte();                                                                     // pad1 (unused)
-
-		db_record_data_t tcpControlBits { b.get_segment(1), dt_unsigned16, 1 };           // TCP flags (ORed)
-		dr.data.insert({ "tcpControlBits", tcpControlBits });
-
-		db_record_data_t protocolIdentifier { b.get_segment(1), dt_unsigned8, 1 };       // IP protocol (TCP, UDP)
-		dr.data.insert({ "protocolIdentifier", protocolIdentifier });
-
-		db_record_data_t ipClassOfService { b.get_segment(1), dt_unsigned8, 1 };         // type of service
-		dr.data.insert({ "ipClassOfService", ipClassOfService });
+		return false;
+	}
 
-		db_record_data_t bgpSourceAsNumber { b.get_segment(2), dt_unsigned32, 2 };       // "Autonomous system number of the source, either origin or peer"
-		dr.data.insert({ "bgpSourceAsNumber", bgpSourceAsNumber });
+	buffer_view records;
 
-		db_record_data_t bgpDestinationAsNumber { b.get_segment(2), dt_unsigned32, 2 };  // "Autonomous system number of the destination, either origin or peer"
-		dr.data.insert({ "bgpDestinationAsNumber", bgpDestinationAsNumber });
+	if (b.get_segment(count * v5_record_length, &records) == false) {
+		dolog(ll_warning, "process_netflow_v5_packet: count %d invalid for packet of %d bytes", count, packet.len);
 
-		db_record_data_t sourceIPv4PrefixLength { b.get_segment(1), dt_unsigned8, 1 };   // source address prefix mask bits
-		dr.data.insert({ "sourceIPv4PrefixLength", sourceIPv4PrefixLength });
+		return false;
+	}
 
-		db_record_data_t destinationIPv4PrefixLength { b.get_segment(1), dt_unsigned8, 1 }; // destination address prefix mask bits
-		dr.data.insert({ "destinationIPv4PrefixLength", destinationIPv4PrefixLength });
+	batch.export_time           = unix_secs;
+	batch.sequence_number       = flow_sequence;
+	batch.observation_domain_id = engine_id;
+	batch.exporter              = hash_address(packet.from);
+	batch.base                  = packet.data;
+	batch.packet                = packet.buffer;
 
-		b.get_net_short();                      // pad2 (unused)
+	if (decode_set(plan, records, &batch) == false)
+		return false;
 
-		if (target)
-			target->insert(dr);
-	}
+	if (target)
+		target->insert_batch(batch);
 
 	if (b.end_reached() == false) {
 		dolog(ll_warning, "process_netflow_v5_packet: data (packet) underflow (%d bytes left)", b.get_n_bytes_left());
@@ -2,14 +2,23 @@
 #include <stdint.h>
 
 #include "db.h"
+#include "decode-plan.h"
 #include "netflow-v9.h"
 
 
 class netflow_v5 : public netflow_v9
 {
+private:
+	// the (fixed) layout of a v5 flow record, as a template
+	decode_plan_t plan;
+
+	void compile_plan();
+
 public:
 	netflow_v5();
 	virtual ~netflow_v5();
 
-	bool process_packet(const uint8_t *const packet, const int packet_size, db *const target);
+	void set_projection(const std::optional<field_projection_t> & projection) override;
+
+	bool process_packet(const packet_t & packet, db *const target);
 };
@@ -11,5 +11,5 @@ public:
 	netflow_v9();
 	virtual ~netflow_v9();
 
-	bool process_packet(const uint8_t *const packet, const int packet_size, db *const target);
+	bool process_packet(const packet_t & packet, db *const target);
 };
@@ -0,0 +1,90 @@
+#include <mutex>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "error.h"
+#include "logging.h"
+#include "packet-pool.h"
+
+
+packet_pool::packet_pool(const int buffers_per_slab) : buffers_per_slab(buffers_per_slab)
+{
+	std::unique_lock<std::mutex> lck(lock);
+
+	add_slab();
+}
+
+packet_pool::~packet_pool()
+{
+	if (free_list.size() != descriptors.size())
+		dolog(ll_warning, "packet_pool::~packet_pool: %zu buffer(s) still in use", descriptors.size() - free_list.size());
+
+	for(auto d : descriptors)
+		delete d;
+
+	for(auto s : slabs)
+		free(s);
+}
+
+// 'lock' must be held
+void packet_pool::add_slab()
+{
+	uint8_t *slab = reinterpret_cast<uint8_t *>(malloc(size_t(buffers_per_slab) * buffer_size));
+	if (!slab)
+		error_exit(true, "packet_pool::add_slab: failed to allocate memory");
+
+	slabs.push_back(slab);
+
+	for(int i=0; i<buffers_per_slab; i++) {
+		packet_buffer_t *d = new packet_buffer_t;
+
+		d->data = &slab[size_t(i) * buffer_size];
+		d->refs = 0;
+		d->pool = this;
+
+		descriptors.push_back(d);
+		free_list.push_back(d);
+	}
+
+	dolog(ll_debug, "packet_pool::add_slab: pool now has %zu buffers", descriptors.size());
+}
+
+packet_ref packet_pool::get()
+{
+	std::unique_lock<std::mutex> lck(lock);
+
+	if (free_list.empty())
+		add_slab();
+
+	packet_buffer_t *d = free_list.back();
+	free_list.pop_back();
+
+	d->refs = 1;
+
+	return packet_ref(d);
+}
+
+packet_ref packet_pool::get(const uint8_t *const data, const int len)
+{
+	packet_ref r = get();
+
+	memcpy(r.get(), data, len);
+
+	return r;
+}
+
+void packet_pool::put(packet_buffer_t *const b)
+{
+	std::unique_lock<std::mutex> lck(lock);
+
+	free_list.push_back(b);
+}
+
+size_t packet_pool::get_n_buffers()
+{
+	std::unique_lock<std::mutex> lck(lock);
+
+	return descriptors.size();
+}
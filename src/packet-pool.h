@@ -0,0 +1,37 @@
+#pragma once
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+#include "packet.h"
+
+
+// fixed size (64 kB) datagram buffers, allocated in slabs and re-used; they
+// are not cleared when handed out
+class packet_pool
+{
+private:
+	const int                       buffers_per_slab;
+
+	std::mutex                      lock;
+	std::vector<uint8_t *>          slabs;
+	std::vector<packet_buffer_t *>  descriptors;
+	std::vector<packet_buffer_t *>  free_list;
+
+	void add_slab();
+
+public:
+	static constexpr int buffer_size = 65536;
+
+	packet_pool(const int buffers_per_slab);
+	virtual ~packet_pool();
+
+	packet_ref get();
+	// copy 'len' bytes from 'data' into a pool buffer
+	packet_ref get(const uint8_t *const data, const int len);
+
+	// invoked by packet_ref when the last reference is gone
+	void       put(packet_buffer_t *const b);
+
+	size_t     get_n_buffers();
+};
@@ -0,0 +1,56 @@
+#include <string.h>
+
+#include "packet.h"
+#include "packet-pool.h"
+
+
+packet_ref & packet_ref::operator=(const packet_ref & other)
+{
+	if (other.b)
+		other.b->refs.fetch_add(1, std::memory_order_relaxed);
+
+	reset();
+
+	b = other.b;
+
+	return *this;
+}
+
+packet_ref & packet_ref::operator=(packet_ref && other) noexcept
+{
+	if (this != &other) {
+		reset();
+
+		b       = other.b;
+		other.b = nullptr;
+	}
+
+	return *this;
+}
+
+packet_ref packet_ref::copy(const uint8_t *const data, const size_t len)
+{
+	packet_buffer_t *d = new packet_buffer_t;
+
+	d->data = new uint8_t[len ? len : 1];
+	d->refs = 1;
+	d->pool = nullptr;
+
+	memcpy(d->data, data, len);
+
+	return packet_ref(d);
+}
+
+void packet_ref::reset()
+{
+	if (b && b->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		if (b->pool)
+			b->pool->put(b);
+		else {
+			delete [] b->data;
+			delete b;
+		}
+	}
+
+	b = nullptr;
+}
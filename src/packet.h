@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+
+class packet_pool;
+
+typedef struct
+{
+	uint8_t          *data;
+	std::atomic_int   refs;
+	// nullptr for a buffer of packet_ref::copy()
+	packet_pool      *pool;
+} packet_buffer_t;
+
+// reference counted handle to a buffer from a packet_pool; the buffer goes
+// back to the pool when the last reference is dropped. copy() makes a
+// buffer of just the size needed, it is freed then.
+class packet_ref
+{
+private:
+	packet_buffer_t *b { nullptr };
+
+public:
+	packet_ref() { }
+	// takes over the (initial) reference of 'b'
+	explicit packet_ref(packet_buffer_t *const b) : b(b) { }
+	packet_ref(const packet_ref & other) : b(other.b) { if (b) b->refs.fetch_add(1, std::memory_order_relaxed); }
+	packet_ref(packet_ref && other) noexcept : b(other.b) { other.b = nullptr; }
+	~packet_ref() { reset(); }
+
+	static packet_ref copy(const uint8_t *const data, const size_t len);
+
+	packet_ref & operator=(const packet_ref & other);
+	packet_ref & operator=(packet_ref && other) noexcept;
+
+	void     reset();
+
+	uint8_t *get() const { return b ? b->data : nullptr; }
+
+	explicit operator bool() const { return b != nullptr; }
+};
+
+typedef struct
+{
+	const uint8_t           *data;
+	int                      len;
+
+	// exporter
+	struct sockaddr_storage  from;
+
+	// receive timestamp in microseconds since the epoch
+	uint64_t                 ts;
+
+	// set when 'data' is in a pool buffer; then it can be kept after the
+	// receiver released the batch
+	packet_ref               buffer;
+
+	// index of the listener (port/protocol) it was received on
+	int                      listener { 0 };
+} packet_t;
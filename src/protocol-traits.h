@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+#include <time.h>
+
+#include "buffer.h"
+#include "logging.h"
+
+
+// what differs between IPFIX (RFC 7011) and NetFlow v9 (RFC 3954): see
+// ipfix::decode_message(), which is compiled for each of them
+
+typedef struct
+{
+	// IPFIX only: of the message, in bytes
+	uint16_t length;
+	time_t   export_time;
+	uint32_t sequence_number;
+	// observation domain id (IPFIX) or source id (v9)
+	uint32_t domain;
+} message_header_t;
+
+struct ipfix_traits
+{
+	static constexpr const char *log_name                = "process_ipfix_packet";
+	static constexpr uint16_t    version                 = 10;
+	static constexpr int         header_length           = 16;
+	// else the message is the whole datagram
+	static constexpr bool        has_message_length      = true;
+	static constexpr uint16_t    template_set_id         = 2;
+	static constexpr uint16_t    options_template_set_id = 3;
+	// bit 15 of the element id, followed by an enterprise number
+	static constexpr bool        has_enterprise_bit      = true;
+
+	// after the version number; the caller checked the length
+	static void get_header(buffer_view & b, message_header_t *const h) {
+		h->length          = b.get_net_short_unchecked();
+		h->export_time     = b.get_net_long_unchecked ();
+		h->sequence_number = b.get_net_long_unchecked ();
+		h->domain          = b.get_net_long_unchecked ();
+
+		dolog(ll_debug, "process_ipfix_packet: length               : %d", h->length);
+		dolog(ll_debug, "process_ipfix_packet: export time          : %ld", h->export_time);
+		dolog(ll_debug, "process_ipfix_packet: sequence number      : %d", h->sequence_number);
+		dolog(ll_debug, "process_ipfix_packet: observation domain id: %d", h->domain);
+	}
+};
+
+struct netflow_v9_traits
+{
+	static constexpr const char *log_name                = "process_netflow_v9_packet";
+	static constexpr uint16_t    version                 = 9;
+	static constexpr int         header_length           = 20;
+	static constexpr bool        has_message_length      = false;
+	static constexpr uint16_t    template_set_id         = 0;
+	static constexpr uint16_t    options_template_set_id = 1;
+	static constexpr bool        has_enterprise_bit      = false;
+
+	static void get_header(buffer_view & b, message_header_t *const h) {
+		uint16_t count     = b.get_net_short_unchecked();  // number of records
+		uint32_t sysuptime = b.get_net_long_unchecked ();
+
+		h->length          = 0;
+		h->export_time     = b.get_net_long_unchecked ();
+		h->sequence_number = b.get_net_long_unchecked ();
+		h->domain          = b.get_net_long_unchecked ();
+
+		dolog(ll_debug, "process_netflow_v9_packet: count          : %d", count);
+		dolog(ll_debug, "process_netflow_v9_packet: sysuptime      : %d", sysuptime);
+		dolog(ll_debug, "process_netflow_v9_packet: export time    : %ld", h->export_time);
+		dolog(ll_debug, "process_netflow_v9_packet: sequence number: %d", h->sequence_number);
+		dolog(ll_debug, "process_netflow_v9_packet: source id      : %d", h->domain);
+	}
+};
@@ -0,0 +1,264 @@
+#include "config.h"
+#if IO_URING_FOUND == 1
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+#include "error.h"
+#include "logging.h"
+#include "receiver-io-uring.h"
+#include "time.h"
+
+
+constexpr int      max_datagram_size = 65535;
+constexpr int      name_size         = sizeof(struct sockaddr_storage);
+constexpr int      control_size      = CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint32_t));
+constexpr int      buffer_size       = sizeof(struct io_uring_recvmsg_out) + name_size + control_size + max_datagram_size;
+constexpr uint16_t buffer_group      = 0;
+
+static int io_uring_setup(const unsigned entries, struct io_uring_params *const p)
+{
+	return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int io_uring_enter(const int ring_fd, const unsigned to_submit, const unsigned min_complete, const unsigned flags)
+{
+	return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+static int io_uring_register(const int ring_fd, const unsigned opcode, void *const arg, const unsigned nr_args)
+{
+	return syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+receiver_io_uring::receiver_io_uring(const int fd, const int n_buffers, const bool latency_mode) :
+	receiver(fd),
+	n_buffers(n_buffers),
+	latency_mode(latency_mode)
+{
+	if (n_buffers < 1 || n_buffers > 32768 || (n_buffers & (n_buffers - 1)))
+		error_exit(false, "receiver_io_uring: number of buffers must be a power of 2 between 1 and 32768");
+
+	struct io_uring_params params { 0 };
+	// every completion of the multishot recvmsg needs a slot
+	params.flags      = IORING_SETUP_CQSIZE;
+	params.cq_entries = n_buffers * 2;
+
+	if (latency_mode) {
+		params.flags         |= IORING_SETUP_SQPOLL;
+		params.sq_thread_idle = 1000;  // ms
+
+		int busy_poll_us = 50;
+		if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us, sizeof busy_poll_us) == -1)
+			dolog(ll_warning, "receiver_io_uring: cannot enable busy-polling on socket %d: %s", fd, strerror(errno));
+	}
+
+	ring_fd = io_uring_setup(8, &params);
+	if (ring_fd == -1)
+		error_exit(true, "receiver_io_uring: cannot create io_uring");
+
+	if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0)
+		error_exit(false, "receiver_io_uring: kernel is too old (no IORING_FEAT_SINGLE_MMAP)");
+
+	// rings
+	// submission- and completion queue share one mapping
+	ring_size = std::max(params.sq_off.array + params.sq_entries * sizeof(uint32_t), params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe));
+
+	ring_ptr = reinterpret_cast<uint8_t *>(mmap(nullptr, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING));
+	if (ring_ptr == MAP_FAILED)
+		error_exit(true, "receiver_io_uring: cannot map io_uring rings");
+
+	sq_tail  = reinterpret_cast<uint32_t *>(ring_ptr + params.sq_off.tail);
+	sq_mask  = reinterpret_cast<uint32_t *>(ring_ptr + params.sq_off.ring_mask);
+	sq_flags = reinterpret_cast<uint32_t *>(ring_ptr + params.sq_off.flags);
+	sq_array = reinterpret_cast<uint32_t *>(ring_ptr + params.sq_off.array);
+
+	cq_head  = reinterpret_cast<uint32_t *>(ring_ptr + params.cq_off.head);
+	cq_tail  = reinterpret_cast<uint32_t *>(ring_ptr + params.cq_off.tail);
+	cq_mask  = reinterpret_cast<uint32_t *>(ring_ptr + params.cq_off.ring_mask);
+	cqes     = reinterpret_cast<struct io_uring_cqe *>(ring_ptr + params.cq_off.cqes);
+
+	sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	sqes = reinterpret_cast<struct io_uring_sqe *>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES));
+	if (sqes == MAP_FAILED)
+		error_exit(true, "receiver_io_uring: cannot map io_uring submission entries");
+
+	// provided buffers
+	buf_ring_size = n_buffers * sizeof(struct io_uring_buf);
+	buf_ring = reinterpret_cast<struct io_uring_buf_ring *>(mmap(nullptr, buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	if (buf_ring == MAP_FAILED)
+		error_exit(true, "receiver_io_uring: cannot allocate buffer ring");
+
+	buffers = reinterpret_cast<uint8_t *>(mmap(nullptr, size_t(n_buffers) * buffer_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	if (buffers == MAP_FAILED)
+		error_exit(true, "receiver_io_uring: cannot allocate %d buffers", n_buffers);
+
+	struct io_uring_buf_reg reg { 0 };
+	reg.ring_addr    = reinterpret_cast<uint64_t>(buf_ring);
+	reg.ring_entries = n_buffers;
+	reg.bgid         = buffer_group;
+
+	if (io_uring_register(ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) == -1)
+		error_exit(true, "receiver_io_uring: cannot register buffer ring (kernel too old?)");
+
+	for(int i=0; i<n_buffers; i++)
+		return_buffer(i);
+
+	int on = 1;
+	if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof on) == -1)
+		dolog(ll_warning, "receiver_io_uring: cannot enable receive timestamps on socket %d: %s", fd, strerror(errno));
+
+	msg.msg_namelen    = name_size;
+	msg.msg_controllen = control_size;
+
+	arm();
+}
+
+receiver_io_uring::~receiver_io_uring()
+{
+	close(ring_fd);
+
+	munmap(buffers, size_t(n_buffers) * buffer_size);
+	munmap(buf_ring, buf_ring_size);
+	munmap(sqes, sqes_size);
+	munmap(ring_ptr, ring_size);
+}
+
+int receiver_io_uring::get_fd() const
+{
+	// the ring becomes readable when completions are pending
+	return ring_fd;
+}
+
+void receiver_io_uring::return_buffer(const uint16_t bid)
+{
+	// not buf_ring->bufs: in C++ the flex-array declaration of older kernel
+	// headers ends up at offset 8 instead of 0
+	struct io_uring_buf *buf = reinterpret_cast<struct io_uring_buf *>(buf_ring) + (buf_tail & (n_buffers - 1));
+
+	buf->addr = reinterpret_cast<uint64_t>(&buffers[size_t(bid) * buffer_size]);
+	buf->len  = buffer_size;
+	buf->bid  = bid;
+
+	buf_tail++;
+
+	__atomic_store_n(&buf_ring->tail, buf_tail, __ATOMIC_RELEASE);
+}
+
+void receiver_io_uring::arm()
+{
+	uint32_t tail  = *sq_tail;
+	uint32_t index = tail & *sq_mask;
+
+	struct io_uring_sqe *sqe = &sqes[index];
+	memset(sqe, 0x00, sizeof *sqe);
+
+	sqe->opcode    = IORING_OP_RECVMSG;
+	sqe->fd        = fd;
+	sqe->addr      = reinterpret_cast<uint64_t>(&msg);
+	sqe->len       = 1;
+	sqe->flags     = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = buffer_group;
+	sqe->ioprio    = IORING_RECV_MULTISHOT;
+
+	sq_array[index] = index;
+
+	__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	// the store above must be visible before sq_flags is read, else a kernel
+	// thread that goes to sleep now is not woken up (io_uring_smp_mb())
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	unsigned flags = 0;
+
+	if (latency_mode) {
+		// the kernel thread picks it up unless it went to sleep
+		if ((__atomic_load_n(sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_NEED_WAKEUP) == 0) {
+			armed = true;
+			return;
+		}
+
+		flags |= IORING_ENTER_SQ_WAKEUP;
+	}
+
+	if (io_uring_enter(ring_fd, 1, 0, flags) == -1)
+		dolog(ll_error, "receiver_io_uring::arm: cannot submit recvmsg: %s", strerror(errno));
+	else
+		armed = true;
+}
+
+bool receiver_io_uring::receive(std::vector<packet_t> & packets)
+{
+	uint32_t head = *cq_head;
+	uint32_t tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+
+	for(; head != tail; head++) {
+		const struct io_uring_cqe *cqe = &cqes[head & *cq_mask];
+
+		if ((cqe->flags & IORING_CQE_F_MORE) == 0)
+			armed = false;
+
+		if (cqe->res < 0) {
+			// -ENOBUFS: all buffers were in use, datagrams stay in the socket buffer
+			if (cqe->res != -ENOBUFS)
+				dolog(ll_error, "receiver_io_uring::receive: problem receiving UDP packet: %s", strerror(-cqe->res));
+
+			continue;
+		}
+
+		if ((cqe->flags & IORING_CQE_F_BUFFER) == 0)
+			continue;
+
+		uint16_t bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+		in_use.push_back(bid);
+
+		uint8_t *const buffer = &buffers[size_t(bid) * buffer_size];
+		auto          *out    = reinterpret_cast<const struct io_uring_recvmsg_out *>(buffer);
+
+		packet_t p { nullptr, 0, { 0 }, 0 };
+
+		memcpy(&p.from, buffer + sizeof(*out), std::min(out->namelen, uint32_t(name_size)));
+
+		// walk the control messages for the receive timestamp and drop counter
+		struct msghdr hdr { 0 };
+		hdr.msg_control    = buffer + sizeof(*out) + name_size;
+		hdr.msg_controllen = out->controllen;
+
+		for(struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg))
+			process_control_message(cmsg, &p.ts);
+
+		if (p.ts == 0)
+			p.ts = get_us();
+
+		p.data = buffer + sizeof(*out) + name_size + control_size;
+		p.len  = out->payloadlen;
+
+		if (out->flags & MSG_TRUNC)
+			dolog(ll_warning, "receiver_io_uring::receive: datagram truncated");
+		else
+			packets.push_back(p);
+	}
+
+	__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+
+	// multishot stops on errors (e.g. when out of buffers)
+	if (!armed)
+		arm();
+
+	return true;
+}
+
+void receiver_io_uring::release()
+{
+	for(auto bid : in_use)
+		return_buffer(bid);
+
+	in_use.clear();
+}
+#endif
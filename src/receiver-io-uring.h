@@ -0,0 +1,66 @@
+#pragma once
+#include "config.h"
+#if IO_URING_FOUND == 1
+#include <stdint.h>
+#include <vector>
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+
+#include "receiver.h"
+
+
+// multishot recvmsg on an io_uring with a provided-buffer ring: the kernel
+// writes datagrams into the registered buffers, no system call per packet
+class receiver_io_uring : public receiver
+{
+private:
+	const int                 n_buffers;
+	const bool                latency_mode;
+	int                       ring_fd    { -1 };
+
+	uint8_t                  *ring_ptr   { nullptr };
+	size_t                    ring_size  { 0 };
+
+	// submission queue
+	uint32_t                 *sq_tail    { nullptr };
+	uint32_t                 *sq_mask    { nullptr };
+	uint32_t                 *sq_flags   { nullptr };
+	uint32_t                 *sq_array   { nullptr };
+	struct io_uring_sqe      *sqes       { nullptr };
+	size_t                    sqes_size  { 0 };
+
+	// completion queue
+	uint32_t                 *cq_head    { nullptr };
+	uint32_t                 *cq_tail    { nullptr };
+	uint32_t                 *cq_mask    { nullptr };
+	struct io_uring_cqe      *cqes       { nullptr };
+
+	// provided buffers
+	struct io_uring_buf_ring *buf_ring   { nullptr };
+	size_t                    buf_ring_size { 0 };
+	uint8_t                  *buffers    { nullptr };
+	uint16_t                  buf_tail   { 0 };
+	std::vector<uint16_t>     in_use;
+
+	// template for the multishot recvmsg; tells the kernel how much
+	// room to reserve in each buffer for the address and control data
+	struct msghdr             msg        { 0 };
+	bool                      armed      { false };
+
+	void arm();
+	void return_buffer(const uint16_t bid);
+
+public:
+	// latency_mode: kernel thread polls the submission queue (SQPOLL) and the
+	// socket is set to busy-poll the NIC; costs a cpu, saves wake-ups
+	receiver_io_uring(const int fd, const int n_buffers, const bool latency_mode);
+	virtual ~receiver_io_uring();
+
+	int  get_fd() const override;
+
+	bool is_busy_polling() const override { return latency_mode; }
+
+	bool receive(std::vector<packet_t> & packets) override;
+	void release() override;
+};
+#endif
@@ -0,0 +1,61 @@
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "logging.h"
+#include "receiver-recv.h"
+#include "time.h"
+
+
+receiver_recv::receiver_recv(const int fd, packet_pool *const pool) : receiver(fd), pool(pool)
+{
+}
+
+receiver_recv::~receiver_recv()
+{
+}
+
+bool receiver_recv::receive(std::vector<packet_t> & packets)
+{
+	// received straight into a pool buffer so that it can outlive the batch
+	packet_ref buffer   = pool->get();
+
+	packet_t   p { buffer.get(), 0, { 0 }, 0 };
+
+	struct iovec iov { buffer.get(), packet_pool::buffer_size };
+
+	// only the kernel drop counter is expected here
+	uint8_t control[CMSG_SPACE(sizeof(uint32_t))] { 0 };
+
+	struct msghdr hdr { 0 };
+	hdr.msg_name       = &p.from;
+	hdr.msg_namelen    = sizeof p.from;
+	hdr.msg_iov        = &iov;
+	hdr.msg_iovlen     = 1;
+	hdr.msg_control    = control;
+	hdr.msg_controllen = sizeof control;
+
+	int rrc = recvmsg(fd, &hdr, MSG_DONTWAIT);
+
+	if (rrc == -1) {
+		if (errno == EAGAIN || errno == EINTR)
+			return true;
+
+		dolog(ll_error, "receiver_recv::receive: problem receiving UDP packet: %s", strerror(errno));
+
+		return false;
+	}
+
+	for(struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg))
+		process_control_message(cmsg, &p.ts);
+
+	p.len    = rrc;
+	p.ts     = get_us();
+	p.buffer = std::move(buffer);
+
+	packets.push_back(std::move(p));
+
+	return true;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "packet-pool.h"
+#include "receiver.h"
+
+
+class receiver_recv : public receiver
+{
+private:
+	packet_pool *const pool;
+
+public:
+	receiver_recv(const int fd, packet_pool *const pool);
+	virtual ~receiver_recv();
+
+	bool receive(std::vector<packet_t> & packets) override;
+};
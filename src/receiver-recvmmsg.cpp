@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include "error.h"
+#include "logging.h"
+#include "receiver-recvmmsg.h"
+#include "time.h"
+
+
+// timestamp, GRO segment size and kernel drop counter
+constexpr int control_size      = CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(uint32_t));
+
+receiver_recvmmsg::receiver_recvmmsg(const int fd, const int batch_size, const bool gro, packet_pool *const pool) :
+	receiver(fd),
+	batch_size(batch_size),
+	pool(pool),
+	buffers(batch_size),
+	msgs(batch_size),
+	iovecs(batch_size),
+	froms(batch_size)
+{
+	controls = reinterpret_cast<uint8_t *>(malloc(size_t(batch_size) * control_size));
+
+	if (!controls)
+		error_exit(true, "receiver_recvmmsg: failed to allocate memory");
+
+	int on = 1;
+	if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof on) == -1)
+		dolog(ll_warning, "receiver_recvmmsg: cannot enable receive timestamps on socket %d: %s", fd, strerror(errno));
+
+	if (gro && setsockopt(fd, SOL_UDP, UDP_GRO, &on, sizeof on) == -1)
+		dolog(ll_warning, "receiver_recvmmsg: cannot enable UDP GRO on socket %d: %s", fd, strerror(errno));
+}
+
+receiver_recvmmsg::~receiver_recvmmsg()
+{
+	free(controls);
+}
+
+bool receiver_recvmmsg::receive(std::vector<packet_t> & packets)
+{
+	// recvmmsg() overwrites the lengths
+	for(int i=0; i<batch_size; i++) {
+		// (re-)fill the slots that were handed out in the previous batch;
+		// with GRO a single "datagram" can be up to 64 kB of coalesced segments
+		if (!buffers[i]) {
+			buffers[i] = pool->get();
+
+			iovecs[i].iov_base = buffers[i].get();
+			iovecs[i].iov_len  = packet_pool::buffer_size;
+		}
+
+		msgs[i].msg_hdr.msg_name       = &froms[i];
+		msgs[i].msg_hdr.msg_namelen    = sizeof(struct sockaddr_storage);
+		msgs[i].msg_hdr.msg_iov        = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen     = 1;
+		msgs[i].msg_hdr.msg_control    = &controls[size_t(i) * control_size];
+		msgs[i].msg_hdr.msg_controllen = control_size;
+		msgs[i].msg_hdr.msg_flags      = 0;
+	}
+
+	int n = recvmmsg(fd, msgs.data(), batch_size, MSG_DONTWAIT, nullptr);
+
+	if (n == -1) {
+		if (errno == EAGAIN || errno == EINTR)
+			return true;
+
+		dolog(ll_error, "receiver_recvmmsg::receive: problem receiving UDP packets: %s", strerror(errno));
+
+		return false;
+	}
+
+	for(int i=0; i<n; i++) {
+		struct msghdr *const hdr = &msgs[i].msg_hdr;
+
+		uint64_t ts       = 0;
+		int      gso_size = 0;
+
+		for(struct cmsghdr *cmsg = CMSG_FIRSTHDR(hdr); cmsg; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+			if (process_control_message(cmsg, &ts))
+				continue;
+
+			if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+				memcpy(&gso_size, CMSG_DATA(cmsg), sizeof gso_size);
+			}
+		}
+
+		if (ts == 0)
+			ts = get_us();
+
+		const uint8_t *data = buffers[i].get();
+		int            len  = msgs[i].msg_len;
+
+		if (gso_size <= 0)
+			gso_size = len;
+
+		// every segment is a datagram as sent by the exporter
+		for(int o=0; o<len; o += gso_size)
+			packets.push_back({ &data[o], std::min(gso_size, len - o), froms[i], ts, buffers[i] });
+
+		buffers[i].reset();
+	}
+
+	return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "packet-pool.h"
+#include "receiver.h"
+
+
+// drains up to 'batch_size' datagrams per system call
+class receiver_recvmmsg : public receiver
+{
+private:
+	const int                        batch_size;
+	packet_pool               *const pool;
+
+	// the kernel writes into pool buffers so that they can outlive the batch
+	std::vector<packet_ref>          buffers;
+	uint8_t                         *controls  { nullptr };
+	std::vector<struct mmsghdr>      msgs;
+	std::vector<struct iovec>        iovecs;
+	std::vector<struct sockaddr_storage> froms;
+
+public:
+	// gro: let the kernel coalesce datagrams of an exporter (UDP_GRO); they're
+	// split again in receive()
+	receiver_recvmmsg(const int fd, const int batch_size, const bool gro, packet_pool *const pool);
+	virtual ~receiver_recvmmsg();
+
+	bool receive(std::vector<packet_t> & packets) override;
+};
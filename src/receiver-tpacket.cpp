@@ -0,0 +1,252 @@
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/ip6.h>
+#include <netinet/udp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+#include "error.h"
+#include "logging.h"
+#include "receiver-tpacket.h"
+
+
+static int create_packet_socket()
+{
+	int fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+	if (fd == -1)
+		error_exit(true, "receiver_tpacket: cannot create packet socket (are you root?)");
+
+	return fd;
+}
+
+receiver_tpacket::receiver_tpacket(const std::string & interface, const int port, const int n_blocks, const int fanout_group) :
+	receiver(create_packet_socket()),
+	port(port),
+	n_blocks(n_blocks),
+	block_size(1 << 20)
+{
+	int version = TPACKET_V3;
+	if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof version) == -1)
+		error_exit(true, "receiver_tpacket: cannot select TPACKET_V3");
+
+	// filter before the ring is created so that nothing else ends up in it
+	attach_filter();
+
+	struct tpacket_req3 req { 0 };
+	req.tp_block_size       = block_size;
+	req.tp_block_nr         = n_blocks;
+	req.tp_frame_size       = 2048;
+	req.tp_frame_nr         = (block_size * n_blocks) / req.tp_frame_size;
+	req.tp_retire_blk_tov   = 10;  // ms; hand over partially filled blocks
+	req.tp_feature_req_word = 0;
+
+	if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof req) == -1)
+		error_exit(true, "receiver_tpacket: cannot create receive ring of %d blocks", n_blocks);
+
+	ring = reinterpret_cast<uint8_t *>(mmap(nullptr, size_t(block_size) * n_blocks, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, fd, 0));
+	if (ring == MAP_FAILED)
+		error_exit(true, "receiver_tpacket: cannot map receive ring");
+
+	int ifindex = if_nametoindex(interface.c_str());
+	if (ifindex == 0)
+		error_exit(true, "receiver_tpacket: interface \"%s\" not found", interface.c_str());
+
+	struct sockaddr_ll ll { 0 };
+	ll.sll_family   = AF_PACKET;
+	ll.sll_protocol = htons(ETH_P_ALL);
+	ll.sll_ifindex  = ifindex;
+
+	if (bind(fd, reinterpret_cast<const sockaddr *>(&ll), sizeof ll) == -1)
+		error_exit(true, "receiver_tpacket: cannot bind to interface \"%s\"", interface.c_str());
+
+	// exports sent by this host itself are not wanted
+	int on = 1;
+	if (setsockopt(fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &on, sizeof on) == -1)
+		dolog(ll_warning, "receiver_tpacket: cannot ignore outgoing packets: %s", strerror(errno));
+
+	// mirror ports deliver traffic for other hosts
+	struct packet_mreq mreq { 0 };
+	mreq.mr_ifindex = ifindex;
+	mreq.mr_type    = PACKET_MR_PROMISC;
+
+	if (setsockopt(fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof mreq) == -1)
+		dolog(ll_warning, "receiver_tpacket: cannot set interface \"%s\" to promiscuous mode: %s", interface.c_str(), strerror(errno));
+
+	// PACKET_FANOUT_HASH keeps a flow (and thus an exporter) on one socket
+	if (fanout_group > 0) {
+		int fanout = (fanout_group & 0xffff) | (PACKET_FANOUT_HASH << 16);
+
+		if (setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof fanout) == -1)
+			error_exit(true, "receiver_tpacket: cannot join fanout group %d", fanout_group);
+	}
+
+	dolog(ll_debug, "receiver_tpacket: capturing UDP port %d on \"%s\" (%d blocks)", port, interface.c_str(), n_blocks);
+}
+
+receiver_tpacket::~receiver_tpacket()
+{
+	munmap(ring, size_t(block_size) * n_blocks);
+}
+
+void receiver_tpacket::attach_filter()
+{
+	const uint32_t p = port;
+
+	// udp dst port 'p', ipv4 (non-fragmented) or ipv6 (no extension headers)
+	struct sock_filter code[] {
+		{ BPF_LD  | BPF_H   | BPF_ABS, 0, 0, 12          },  //  0: ethertype
+		{ BPF_JMP | BPF_JEQ | BPF_K,   0, 7, ETH_P_IP    },  //  1: ipv4? else 9
+		{ BPF_LD  | BPF_B   | BPF_ABS, 0, 0, 23          },  //  2: ip protocol
+		{ BPF_JMP | BPF_JEQ | BPF_K,   0, 11, IPPROTO_UDP },  //  3: udp? else drop
+		{ BPF_LD  | BPF_H   | BPF_ABS, 0, 0, 20          },  //  4: fragment offset/flags
+		{ BPF_JMP | BPF_JSET| BPF_K,   9, 0, 0x3fff      },  //  5: fragment? drop
+		{ BPF_LDX | BPF_B   | BPF_MSH, 0, 0, 14          },  //  6: x = ip header length
+		{ BPF_LD  | BPF_H   | BPF_IND, 0, 0, 16          },  //  7: udp dst port
+		{ BPF_JMP | BPF_JA,            0, 0, 4           },  //  8: to 13
+		{ BPF_JMP | BPF_JEQ | BPF_K,   0, 5, ETH_P_IPV6  },  //  9: ipv6? else drop
+		{ BPF_LD  | BPF_B   | BPF_ABS, 0, 0, 20          },  // 10: next header
+		{ BPF_JMP | BPF_JEQ | BPF_K,   0, 3, IPPROTO_UDP },  // 11: udp? else drop
+		{ BPF_LD  | BPF_H   | BPF_ABS, 0, 0, 56          },  // 12: udp dst port
+		{ BPF_JMP | BPF_JEQ | BPF_K,   0, 1, p           },  // 13: port? else drop
+		{ BPF_RET | BPF_K,             0, 0, 0x40000     },  // 14: accept
+		{ BPF_RET | BPF_K,             0, 0, 0           },  // 15: drop
+	};
+
+	struct sock_fprog program { sizeof(code) / sizeof(code[0]), code };
+
+	if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof program) == -1)
+		error_exit(true, "receiver_tpacket: cannot attach filter");
+}
+
+void receiver_tpacket::process_frame(const struct tpacket3_hdr *const hdr, std::vector<packet_t> & packets)
+{
+	// PACKET_IGNORE_OUTGOING is not honoured for fanout groups on older kernels
+	auto *ll = reinterpret_cast<const struct sockaddr_ll *>(reinterpret_cast<const uint8_t *>(hdr) + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+	if (ll->sll_pkttype == PACKET_OUTGOING)
+		return;
+
+	const uint8_t *frame = reinterpret_cast<const uint8_t *>(hdr) + hdr->tp_mac;
+	int            len   = hdr->tp_snaplen;
+
+	if (len < ETH_HLEN)
+		return;
+
+	uint16_t ether_type = (frame[12] << 8) | frame[13];
+
+	const uint8_t *ip     = frame + ETH_HLEN;
+	int            ip_len = len - ETH_HLEN;
+
+	packet_t p { nullptr, 0, { 0 }, uint64_t(hdr->tp_sec) * 1000000 + hdr->tp_nsec / 1000 };
+
+	const uint8_t *udp = nullptr;
+
+	if (ether_type == ETH_P_IP) {
+		if (ip_len < int(sizeof(struct iphdr)))
+			return;
+
+		auto *ip4    = reinterpret_cast<const struct iphdr *>(ip);
+		int   hdr_len = ip4->ihl * 4;
+
+		if (ip_len < hdr_len + int(sizeof(struct udphdr)))
+			return;
+
+		auto *from = reinterpret_cast<struct sockaddr_in *>(&p.from);
+		from->sin_family      = AF_INET;
+		from->sin_addr.s_addr = ip4->saddr;
+
+		udp     = ip + hdr_len;
+		ip_len -= hdr_len;
+	}
+	else if (ether_type == ETH_P_IPV6) {
+		if (ip_len < int(sizeof(struct ip6_hdr) + sizeof(struct udphdr)))
+			return;
+
+		auto *ip6 = reinterpret_cast<const struct ip6_hdr *>(ip);
+
+		auto *from = reinterpret_cast<struct sockaddr_in6 *>(&p.from);
+		from->sin6_family = AF_INET6;
+		memcpy(&from->sin6_addr, &ip6->ip6_src, sizeof from->sin6_addr);
+
+		udp     = ip + sizeof(struct ip6_hdr);
+		ip_len -= sizeof(struct ip6_hdr);
+	}
+	else {
+		return;
+	}
+
+	auto *udp_hdr = reinterpret_cast<const struct udphdr *>(udp);
+	int   udp_len = ntohs(udp_hdr->len);
+
+	// truncated by the snap-length
+	if (udp_len > ip_len || udp_len < int(sizeof(struct udphdr))) {
+		dolog(ll_debug, "receiver_tpacket::process_frame: datagram truncated (%d bytes, %d available)", udp_len, ip_len);
+		return;
+	}
+
+	if (p.from.ss_family == AF_INET)
+		reinterpret_cast<struct sockaddr_in *>(&p.from)->sin_port = udp_hdr->source;
+	else
+		reinterpret_cast<struct sockaddr_in6 *>(&p.from)->sin6_port = udp_hdr->source;
+
+	p.data = udp + sizeof(struct udphdr);
+	p.len  = udp_len - sizeof(struct udphdr);
+
+	packets.push_back(p);
+}
+
+bool receiver_tpacket::receive(std::vector<packet_t> & packets)
+{
+	auto *block = reinterpret_cast<struct tpacket_block_desc *>(ring + size_t(current) * block_size);
+
+	if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+		return true;
+
+	block_in_use = true;
+
+	uint32_t n_packets = block->hdr.bh1.num_pkts;
+	auto    *hdr       = reinterpret_cast<const struct tpacket3_hdr *>(reinterpret_cast<const uint8_t *>(block) + block->hdr.bh1.offset_to_first_pkt);
+
+	for(uint32_t i=0; i<n_packets; i++) {
+		process_frame(hdr, packets);
+
+		hdr = reinterpret_cast<const struct tpacket3_hdr *>(reinterpret_cast<const uint8_t *>(hdr) + hdr->tp_next_offset);
+	}
+
+	return true;
+}
+
+void receiver_tpacket::release()
+{
+	// hand the block back to the kernel; poll() keeps signalling while
+	// a block is owned by userspace
+	if (block_in_use) {
+		auto *block = reinterpret_cast<struct tpacket_block_desc *>(ring + size_t(current) * block_size);
+
+		__atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+
+		current      = (current + 1) % n_blocks;
+		block_in_use = false;
+	}
+}
+
+uint64_t receiver_tpacket::get_n_kernel_drops()
+{
+	struct tpacket_stats_v3 stats { 0 };
+	socklen_t               len = sizeof stats;
+
+	// the kernel resets these counters on each read
+	if (getsockopt(fd, SOL_PACKET, PACKET_STATISTICS, &stats, &len) == -1)
+		dolog(ll_warning, "receiver_tpacket::get_n_kernel_drops: cannot retrieve statistics: %s", strerror(errno));
+	else
+		n_kernel_drops += stats.tp_drops;
+
+	return n_kernel_drops;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <linux/if_packet.h>
+
+#include "receiver.h"
+
+
+// passive capture of UDP datagrams to 'port' from a TPACKET_V3 ring (e.g.
+// on a mirror port); datagrams are processed straight from the ring
+class receiver_tpacket : public receiver
+{
+private:
+	const int               port;
+	const int               n_blocks;
+	const uint32_t          block_size;
+
+	uint8_t                *ring         { nullptr };
+	int                     current      { 0 };
+	bool                    block_in_use { false };
+
+	void attach_filter();
+	void process_frame(const struct tpacket3_hdr *const hdr, std::vector<packet_t> & packets);
+
+public:
+	// fanout_group: workers with the same group (> 0) share the traffic
+	receiver_tpacket(const std::string & interface, const int port, const int n_blocks, const int fanout_group);
+	virtual ~receiver_tpacket();
+
+	bool receive(std::vector<packet_t> & packets) override;
+	void release() override;
+
+	// datagrams that did not fit in the ring
+	uint64_t get_n_kernel_drops() override;
+	// the ring cannot be resized while in use
+	int      grow_receive_buffer() override { return -1; }
+};
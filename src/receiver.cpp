@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "net.h"
+#include "receiver.h"
+
+
+receiver::receiver(const int fd) : fd(fd)
+{
+}
+
+receiver::~receiver()
+{
+	close(fd);
+}
+
+bool receiver::process_control_message(const struct cmsghdr *const cmsg, uint64_t *const ts)
+{
+	if (cmsg->cmsg_level != SOL_SOCKET)
+		return false;
+
+	if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+		struct timespec tv { 0 };
+		memcpy(&tv, CMSG_DATA(cmsg), sizeof tv);
+
+		*ts = uint64_t(tv.tv_sec) * uint64_t(1000 * 1000) + uint64_t(tv.tv_nsec / 1000);
+
+		return true;
+	}
+
+	if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+		// total for the socket at the time this datagram was queued
+		uint32_t n_dropped = 0;
+		memcpy(&n_dropped, CMSG_DATA(cmsg), sizeof n_dropped);
+
+		n_kernel_drops = std::max(n_kernel_drops, uint64_t(n_dropped));
+
+		return true;
+	}
+
+	return false;
+}
+
+int receiver::grow_receive_buffer()
+{
+	int current = get_receive_buffer_size(fd);
+
+	if (current == -1 || current >= receive_buffer_max)
+		return -1;
+
+	return set_receive_buffer_size(fd, std::min(current * 2, receive_buffer_max));
+}
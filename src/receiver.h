@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <sys/socket.h>
+
+#include "packet.h"
+
+
+class receiver
+{
+protected:
+	const int fd;
+
+	// as reported by the kernel (SO_RXQ_OVFL)
+	uint64_t  n_kernel_drops       { 0 };
+	// grow the receive buffer up to this size when the kernel drops datagrams
+	int       receive_buffer_max   { 0 };
+
+	// handles receive timestamps and drop counters, returns false for
+	// other control messages
+	bool process_control_message(const struct cmsghdr *const cmsg, uint64_t *const ts);
+
+public:
+	// takes ownership of 'fd'
+	receiver(const int fd);
+	virtual ~receiver();
+
+	// file descriptor to poll() on for POLLIN
+	virtual int  get_fd() const { return fd; }
+
+	// when true, receive() should be invoked in a loop instead of waiting
+	// in poll()
+	virtual bool is_busy_polling() const { return false; }
+
+	// appends what is available to 'packets'; the data stays valid until
+	// release() is invoked
+	virtual bool receive(std::vector<packet_t> & packets) = 0;
+	virtual void release() { }
+
+	// total number of datagrams the kernel dropped because they were not
+	// retrieved in time
+	virtual uint64_t get_n_kernel_drops() { return n_kernel_drops; }
+
+	// 0 disables the adaptive mode
+	void         set_receive_buffer_max(const int max_size) { receive_buffer_max = max_size; }
+	// doubles the receive buffer (up to the maximum), returns the new size
+	// or -1 when it cannot grow
+	virtual int  grow_receive_buffer();
+};
@@ -0,0 +1,128 @@
+#pragma once
+#include <atomic>
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <vector>
+#include <sys/eventfd.h>
+
+#include "error.h"
+
+
+// bounded lock-free single-producer/single-consumer ring; slots are re-used
+// so that (after warming up) nothing gets allocated
+template <typename T>
+class spsc_queue
+{
+private:
+	std::vector<T>        slots;
+	const size_t          size;
+
+	// written by the consumer
+	alignas(64) std::atomic<size_t>   head { 0 };
+	// written by the producer
+	alignas(64) std::atomic<size_t>   tail { 0 };
+	std::atomic<size_t>               high_water_mark { 0 };
+	std::atomic<uint64_t>             n_overflows     { 0 };
+
+	alignas(64) std::atomic_bool      consumer_waiting { false };
+	int                               wakeup_fd { -1 };
+
+public:
+	spsc_queue(const size_t size) : slots(size), size(size)
+	{
+		wakeup_fd = eventfd(0, EFD_NONBLOCK);
+		if (wakeup_fd == -1)
+			error_exit(true, "spsc_queue: cannot create eventfd");
+	}
+
+	virtual ~spsc_queue()
+	{
+		close(wakeup_fd);
+	}
+
+	// producer: slot to fill, nullptr (and counted as overflow) when full
+	T *get_write_slot()
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+
+		if (t - head.load(std::memory_order_acquire) == size) {
+			n_overflows++;
+
+			return nullptr;
+		}
+
+		return &slots[t % size];
+	}
+
+	// producer: make the slot returned by get_write_slot() available
+	void push()
+	{
+		size_t t = tail.load(std::memory_order_relaxed) + 1;
+
+		tail.store(t, std::memory_order_release);
+
+		size_t in_use = t - head.load(std::memory_order_relaxed);
+		if (in_use > high_water_mark.load(std::memory_order_relaxed))
+			high_water_mark.store(in_use, std::memory_order_relaxed);
+	}
+
+	// producer: wake up the consumer (if it is waiting), e.g. after a batch
+	void notify()
+	{
+		if (consumer_waiting.exchange(false)) {
+			uint64_t v = 1;
+
+			if (write(wakeup_fd, &v, sizeof v) == -1 && errno != EAGAIN)
+				error_exit(true, "spsc_queue::notify: cannot signal consumer");
+		}
+	}
+
+	// consumer: oldest slot, nullptr when empty
+	T *get_read_slot()
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+
+		if (h == tail.load(std::memory_order_acquire))
+			return nullptr;
+
+		return &slots[h % size];
+	}
+
+	// consumer: return the slot returned by get_read_slot() to the producer
+	void pop()
+	{
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// consumer: wait at most 'timeout_ms' for data, returns true if there is any
+	bool wait(const int timeout_ms)
+	{
+		consumer_waiting = true;
+
+		// a push() could have happened before consumer_waiting was set
+		if (head.load(std::memory_order_relaxed) != tail.load(std::memory_order_acquire)) {
+			consumer_waiting = false;
+
+			return true;
+		}
+
+		struct pollfd fds[] { { wakeup_fd, POLLIN, 0 } };
+
+		if (poll(fds, 1, timeout_ms) == 1) {
+			uint64_t v = 0;
+
+			if (read(wakeup_fd, &v, sizeof v) == -1 && errno != EAGAIN)
+				error_exit(true, "spsc_queue::wait: cannot read wakeup event");
+		}
+
+		consumer_waiting = false;
+
+		return head.load(std::memory_order_relaxed) != tail.load(std::memory_order_acquire);
+	}
+
+	size_t   get_size()            const { return size;            }
+	size_t   get_high_water_mark() const { return high_water_mark; }
+	uint64_t get_n_overflows()     const { return n_overflows;     }
+};
@@ -0,0 +1,183 @@
+#include <memory>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "logging.h"
+#include "template-cache.h"
+
+
+// both tables are kept at most half full
+constexpr size_t initial_slots = 16;
+
+exporter_templates::exporter_templates() : keys(initial_slots), values(initial_slots)
+{
+}
+
+exporter_templates::~exporter_templates()
+{
+}
+
+// slot of 'template_id' or of the empty slot where it would go
+size_t exporter_templates::find_slot(const uint16_t template_id) const
+{
+	const size_t mask = keys.size() - 1;
+	size_t       slot = (template_id * 2654435761u) & mask;
+
+	while(keys[slot] != 0 && keys[slot] != template_id + 1u)
+		slot = (slot + 1) & mask;
+
+	return slot;
+}
+
+void exporter_templates::grow()
+{
+	std::vector<uint32_t>      old_keys  (keys.size() * 2);
+	std::vector<decode_plan_t> old_values(keys.size() * 2);
+
+	old_keys  .swap(keys);
+	old_values.swap(values);
+
+	for(size_t i=0; i<old_keys.size(); i++) {
+		if (old_keys[i] == 0)
+			continue;
+
+		size_t slot = find_slot(old_keys[i] - 1);
+
+		keys  [slot] = old_keys[i];
+		values[slot] = std::move(old_values[i]);
+	}
+}
+
+const decode_plan_t *exporter_templates::get(const uint16_t template_id) const
+{
+	size_t slot = find_slot(template_id);
+
+	if (keys[slot] == 0)
+		return nullptr;
+
+	return &values[slot];
+}
+
+void exporter_templates::put(const uint16_t template_id, decode_plan_t && plan)
+{
+	size_t slot = find_slot(template_id);
+
+	if (keys[slot] == 0) {
+		if ((n + 1) * 2 > keys.size()) {
+			grow();
+
+			slot = find_slot(template_id);
+		}
+
+		keys[slot] = template_id + 1u;
+		n++;
+	}
+
+	values[slot] = std::move(plan);
+}
+
+template_cache::template_cache() : keys(initial_slots), values(initial_slots)
+{
+}
+
+template_cache::~template_cache()
+{
+}
+
+template_cache::exporter_key_t template_cache::make_key(const sockaddr_storage & from, const uint32_t domain)
+{
+	exporter_key_t key { };
+
+	if (from.ss_family == AF_INET) {
+		key.address[10] = key.address[11] = 0xff;
+		memcpy(&key.address[12], &reinterpret_cast<const sockaddr_in *>(&from)->sin_addr, 4);
+	}
+	else if (from.ss_family == AF_INET6) {
+		memcpy(key.address, &reinterpret_cast<const sockaddr_in6 *>(&from)->sin6_addr, 16);
+	}
+
+	key.domain = domain;
+	key.used   = true;
+
+	return key;
+}
+
+// FNV-1a
+uint64_t template_cache::hash(const exporter_key_t & key)
+{
+	uint64_t h = 14695981039346656037ull;
+
+	for(int i=0; i<16; i++)
+		h = (h ^ key.address[i]) * 1099511628211ull;
+
+	for(int i=0; i<4; i++)
+		h = (h ^ ((key.domain >> (i * 8)) & 255)) * 1099511628211ull;
+
+	return h;
+}
+
+static bool keys_equal(const uint8_t *const a_address, const uint32_t a_domain, const uint8_t *const b_address, const uint32_t b_domain)
+{
+	return a_domain == b_domain && memcmp(a_address, b_address, 16) == 0;
+}
+
+size_t template_cache::find_slot(const exporter_key_t & key) const
+{
+	const size_t mask = keys.size() - 1;
+	size_t       slot = hash(key) & mask;
+
+	while(keys[slot].used && !keys_equal(keys[slot].address, keys[slot].domain, key.address, key.domain))
+		slot = (slot + 1) & mask;
+
+	return slot;
+}
+
+void template_cache::grow()
+{
+	std::vector<exporter_key_t>                      old_keys  (keys.size() * 2);
+	std::vector<std::unique_ptr<exporter_templates> > old_values(keys.size() * 2);
+
+	old_keys  .swap(keys);
+	old_values.swap(values);
+
+	for(size_t i=0; i<old_keys.size(); i++) {
+		if (old_keys[i].used == false)
+			continue;
+
+		size_t slot = find_slot(old_keys[i]);
+
+		keys  [slot] = old_keys[i];
+		values[slot] = std::move(old_values[i]);
+	}
+}
+
+exporter_templates *template_cache::get_exporter(const sockaddr_storage & from, const uint32_t domain)
+{
+	exporter_key_t key = make_key(from, domain);
+
+	if (last && keys_equal(last_key.address, last_key.domain, key.address, key.domain))
+		return last;
+
+	size_t slot = find_slot(key);
+
+	if (keys[slot].used == false) {
+		if ((n + 1) * 2 > keys.size()) {
+			grow();
+
+			slot = find_slot(key);
+		}
+
+		keys  [slot] = key;
+		values[slot] = std::make_unique<exporter_templates>();
+		n++;
+
+		dolog(ll_debug, "template_cache::get_exporter: new exporter/domain (%u), now %zu known", domain, n);
+	}
+
+	last_key = key;
+	last     = values[slot].get();  // stays valid when the table grows
+
+	return last;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <memory>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <vector>
+
+#include "decode-plan.h"
+
+
+// the (compiled) templates of one exporter (source address + observation domain or
+// source id), keyed by template id; open addressing with linear probing
+class exporter_templates
+{
+private:
+	// template id + 1, 0 is an empty slot
+	std::vector<uint32_t>      keys;
+	std::vector<decode_plan_t> values;
+	size_t                     n { 0 };
+
+	size_t find_slot(const uint16_t template_id) const;
+	void   grow();
+
+public:
+	exporter_templates();
+	virtual ~exporter_templates();
+
+	// nullptr if not known (yet)
+	const decode_plan_t *get(const uint16_t template_id) const;
+	void                 put(const uint16_t template_id, decode_plan_t && plan);
+
+	size_t               size() const { return n; }
+};
+
+// templates of all exporters; one instance per parser so that each worker
+// (and each TCP session) has its own
+class template_cache
+{
+private:
+	typedef struct {
+		uint8_t  address[16];  // IPv4 is stored as IPv4-mapped IPv6
+		uint32_t domain;
+		bool     used;
+	} exporter_key_t;
+
+	std::vector<exporter_key_t>                      keys;
+	std::vector<std::unique_ptr<exporter_templates> > values;
+	size_t                                           n { 0 };
+
+	// most exporters send many packets in a row
+	exporter_key_t                                   last_key { };
+	exporter_templates                              *last { nullptr };
+
+	static exporter_key_t make_key(const sockaddr_storage & from, const uint32_t domain);
+	static uint64_t       hash(const exporter_key_t & key);
+	size_t                find_slot(const exporter_key_t & key) const;
+	void                  grow();
+
+public:
+	template_cache();
+	virtual ~template_cache();
+
+	// creates an empty set if this exporter was not seen before
+	exporter_templates *get_exporter(const sockaddr_storage & from, const uint32_t domain);
+
+	size_t              get_n_exporters() const { return n; }
+};
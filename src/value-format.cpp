@@ -0,0 +1,425 @@
+#include <charconv>
+#include <endian.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+#include "logging.h"
+#include "value-format.h"
+
+
+static constexpr char hex_digits[] = "0123456789abcdef";
+
+typedef struct
+{
+	char    pairs[256][2];
+} hex_table_t;
+
+static constexpr hex_table_t make_hex_table()
+{
+	hex_table_t table { };
+
+	for(int i=0; i<256; i++) {
+		table.pairs[i][0] = hex_digits[i >> 4];
+		table.pairs[i][1] = hex_digits[i & 15];
+	}
+
+	return table;
+}
+
+static constexpr hex_table_t hex_table = make_hex_table();
+
+// 0 ... 255 in decimal, for IPv4 addresses
+typedef struct
+{
+	char    text[256][3];
+	uint8_t len[256];
+} decimal_table_t;
+
+static constexpr decimal_table_t make_decimal_table()
+{
+	decimal_table_t table { };
+
+	for(int i=0; i<256; i++) {
+		int n = 0;
+
+		if (i >= 100)
+			table.text[i][n++] = '0' + i / 100;
+		if (i >= 10)
+			table.text[i][n++] = '0' + i / 10 % 10;
+		table.text[i][n++] = '0' + i % 10;
+
+		table.len[i] = n;
+	}
+
+	return table;
+}
+
+static constexpr decimal_table_t decimal_table = make_decimal_table();
+
+static char *put_hex_bytes(char *o, const uint8_t *const p, const int len, const char separator)
+{
+	for(int i=0; i<len; i++) {
+		if (separator && i)
+			*o++ = separator;
+
+		*o++ = hex_table.pairs[p[i]][0];
+		*o++ = hex_table.pairs[p[i]][1];
+	}
+
+	return o;
+}
+
+static char *put_ipv4(char *o, const uint8_t *const p)
+{
+	for(int i=0; i<4; i++) {
+		if (i)
+			*o++ = '.';
+
+		memcpy(o, decimal_table.text[p[i]], decimal_table.len[p[i]]);
+		o += decimal_table.len[p[i]];
+	}
+
+	return o;
+}
+
+// lower case, without leading zeros
+static char *put_hex16(char *o, const uint16_t v)
+{
+	bool started = false;
+
+	for(int shift=12; shift>=0; shift-=4) {
+		int digit = (v >> shift) & 15;
+
+		if (digit || started || shift == 0) {
+			*o++    = hex_digits[digit];
+			started = true;
+		}
+	}
+
+	return o;
+}
+
+// RFC 5952: the longest run (of at least two) of zero groups is replaced by
+// "::", the first one when there are more of the same length
+static char *put_ipv6(char *o, const uint8_t *const p)
+{
+	uint16_t groups[8];
+
+	for(int i=0; i<8; i++)
+		groups[i] = (p[i * 2] << 8) | p[i * 2 + 1];
+
+	int best_start = -1;
+	int best_len   = 0;
+
+	for(int i=0; i<8;) {
+		if (groups[i]) {
+			i++;
+			continue;
+		}
+
+		int j = i;
+		while(j < 8 && groups[j] == 0)
+			j++;
+
+		if (j - i > best_len && j - i >= 2) {
+			best_start = i;
+			best_len   = j - i;
+		}
+
+		i = j;
+	}
+
+	// IPv4-mapped (RFC 5952 5.)
+	if (best_start == 0 && best_len == 5 && groups[5] == 0xffff) {
+		memcpy(o, "::ffff:", 7);
+
+		return put_ipv4(o + 7, &p[12]);
+	}
+
+	for(int i=0; i<8; i++) {
+		if (i == best_start) {
+			*o++ = ':';
+			*o++ = ':';
+
+			i += best_len - 1;
+
+			continue;
+		}
+
+		if (i > 0 && i != best_start + best_len)
+			*o++ = ':';
+
+		o = put_hex16(o, groups[i]);
+	}
+
+	return o;
+}
+
+static uint64_t get_unsigned(const uint8_t *const p, const int len)
+{
+	uint64_t v = 0;
+
+	for(int i=0; i<len; i++)
+		v = (v << 8) | p[i];
+
+	return v;
+}
+
+bool get_integer_value(const data_type_t type, const uint8_t *const value, const int len, int64_t *const out)
+{
+	int  max_len   = 0;
+	bool is_signed = false;
+
+	switch(type) {
+		case dt_unsigned8:  max_len = 1; break;
+		case dt_unsigned16: max_len = 2; break;
+		case dt_unsigned32: max_len = 4; break;
+		case dt_unsigned64: max_len = 8; break;
+		case dt_signed8:    max_len = 1; is_signed = true; break;
+		case dt_signed16:   max_len = 2; is_signed = true; break;
+		case dt_signed32:   max_len = 4; is_signed = true; break;
+		case dt_signed64:   max_len = 8; is_signed = true; break;
+
+		// timestamps are not encoded with reduced size
+		case dt_dateTimeSeconds:
+			if (len != 4)
+				return false;
+			max_len = 4;
+			break;
+
+		case dt_dateTimeMilliseconds:
+		case dt_dateTimeMicroseconds:
+		case dt_dateTimeNanoseconds:
+			if (len != 8)
+				return false;
+			max_len = 8;
+			break;
+
+		default:
+			return false;
+	}
+
+	if (len < 1 || len > max_len)
+		return false;
+
+	uint64_t v = get_unsigned(value, len);
+
+	if (is_signed && len < 8) {
+		const int shift = 64 - len * 8;
+
+		v = uint64_t(int64_t(v << shift) >> shift);
+	}
+
+	*out = int64_t(v);
+
+	return true;
+}
+
+bool get_float_value(const data_type_t type, const uint8_t *const value, const int len, double *const out)
+{
+	if (type != dt_float32 && type != dt_float64)
+		return false;
+
+	// a float64 may be sent as a float32 (reduced size encoding)
+	if (len == 4) {
+		uint32_t bits = 0;
+		memcpy(&bits, value, 4);
+		bits = be32toh(bits);
+
+		float f = 0.;
+		memcpy(&f, &bits, 4);
+
+		*out = f;
+
+		return true;
+	}
+
+	if (len == 8 && type == dt_float64) {
+		uint64_t bits = 0;
+		memcpy(&bits, value, 8);
+		bits = be64toh(bits);
+
+		memcpy(out, &bits, 8);
+
+		return true;
+	}
+
+	return false;
+}
+
+static int invalid_length(const data_type_t type, const int len)
+{
+	dolog(ll_warning, "format_value: unexpected length %d found for type %d", len, type);
+
+	return -1;
+}
+
+static int format_fixed(const data_type_t type, const uint8_t *const value, const int len, char *const out, const int out_size)
+{
+	char  temp[value_text_max];
+	char *end = nullptr;
+
+	switch(type) {
+		case dt_unsigned8:
+		case dt_unsigned16:
+		case dt_unsigned32:
+		case dt_unsigned64:
+		case dt_dateTimeSeconds:
+		case dt_dateTimeMilliseconds:
+		case dt_dateTimeMicroseconds:
+		case dt_dateTimeNanoseconds: {
+				int64_t v = 0;
+				if (get_integer_value(type, value, len, &v) == false)
+					return invalid_length(type, len);
+
+				end = std::to_chars(temp, temp + sizeof temp, uint64_t(v)).ptr;
+			}
+			break;
+
+		case dt_signed8:
+		case dt_signed16:
+		case dt_signed32:
+		case dt_signed64: {
+				int64_t v = 0;
+				if (get_integer_value(type, value, len, &v) == false)
+					return invalid_length(type, len);
+
+				end = std::to_chars(temp, temp + sizeof temp, v).ptr;
+			}
+			break;
+
+		case dt_float32:
+		case dt_float64: {
+				double v = 0.;
+				if (get_float_value(type, value, len, &v) == false)
+					return invalid_length(type, len);
+
+				// as "%f"
+				auto rc = std::to_chars(temp, temp + sizeof temp, v, std::chars_format::fixed, 6);
+				if (rc.ec != std::errc())
+					return -1;
+
+				end = rc.ptr;
+			}
+			break;
+
+		case dt_boolean:
+			if (len != 1)
+				return invalid_length(type, len);
+
+			if (value[0] == 1) {
+				memcpy(temp, "true", 4);
+				end = temp + 4;
+			}
+			else if (value[0] == 2) {
+				memcpy(temp, "false", 5);
+				end = temp + 5;
+			}
+			else {
+				dolog(ll_warning, "format_value: unexpected value %d found for type %d, expected 1 or 2", value[0], type);
+
+				return -1;
+			}
+			break;
+
+		case dt_macAddress:
+			if (len != 6)
+				return invalid_length(type, len);
+
+			end = put_hex_bytes(temp, value, 6, ':');
+			break;
+
+		case dt_ipv4Address:
+			if (len != 4)
+				return invalid_length(type, len);
+
+			end = put_ipv4(temp, value);
+			break;
+
+		case dt_ipv6Address:
+			if (len != 16)
+				return invalid_length(type, len);
+
+			end = put_ipv6(temp, value);
+			break;
+
+		// case dt_basicList,
+		// case dt_subTemplateList,
+		// case dt_subTemplateMultiList
+
+		default:
+			dolog(ll_warning, "format_value: type %d not supported", type);
+
+			return -1;
+	}
+
+	int n = end - temp;
+
+	if (n > out_size)
+		return -1;
+
+	memcpy(out, temp, n);
+
+	return n;
+}
+
+int format_value(const data_type_t type, const uint8_t *const value, const int len, char *const out, const int out_size)
+{
+	if (type == dt_string) {
+		if (len > out_size)
+			return -1;
+
+		memcpy(out, value, len);
+
+		return len;
+	}
+
+	if (type == dt_octetArray) {
+		if (len * 2 > out_size)
+			return -1;
+
+		put_hex_bytes(out, value, len, 0x00);
+
+		return len * 2;
+	}
+
+	return format_fixed(type, value, len, out, out_size);
+}
+
+bool append_value(const data_type_t type, const uint8_t *const value, const int len, std::string *const out)
+{
+	size_t old_size = out->size();
+	int    max_size = type == dt_string ? len : (type == dt_octetArray ? len * 2 : value_text_max);
+
+	out->resize(old_size + max_size);
+
+	int n = format_value(type, value, len, out->data() + old_size, max_size);
+
+	out->resize(old_size + (n == -1 ? 0 : n));
+
+	return n != -1;
+}
+
+bool value_equals(const data_type_t type, const uint8_t *const value, const int len, const std::string & text)
+{
+	if (type == dt_string)
+		return size_t(len) == text.size() && memcmp(value, text.data(), len) == 0;
+
+	if (type == dt_octetArray) {
+		if (size_t(len) * 2 != text.size())
+			return false;
+
+		for(int i=0; i<len; i++) {
+			if (memcmp(hex_table.pairs[value[i]], &text[i * 2], 2) != 0)
+				return false;
+		}
+
+		return true;
+	}
+
+	char temp[value_text_max];
+	int  n = format_value(type, value, len, temp, sizeof temp);
+
+	return n != -1 && size_t(n) == text.size() && memcmp(temp, text.data(), n) == 0;
+}
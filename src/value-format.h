@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+
+#include "ipfix-common.h"
+
+
+// longest text of a fixed length type: a float64 in "%f" notation
+constexpr int value_text_max = 320;
+
+// renders the value of a field ('len' bytes in network order) as text into
+// 'out' (not 0-terminated); returns the number of characters or -1 when the
+// type is not supported, 'len' is not valid for it or 'out' is too small.
+// does not allocate.
+int  format_value(const data_type_t type, const uint8_t *const value, const int len, char *const out, const int out_size);
+
+// appends the text to 'out'; re-use 'out' to not allocate
+bool append_value(const data_type_t type, const uint8_t *const value, const int len, std::string *const out);
+
+// 'text' as format_value() would render the value
+bool value_equals(const data_type_t type, const uint8_t *const value, const int len, const std::string & text);
+
+// integers (reduced size encoding included) and timestamps; signed types
+// are sign extended
+bool get_integer_value(const data_type_t type, const uint8_t *const value, const int len, int64_t *const out);
+
+// float32 and float64 (also when sent as a float32)
+bool get_float_value(const data_type_t type, const uint8_t *const value, const int len, double *const out);
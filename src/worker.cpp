@@ -0,0 +1,253 @@
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdexcept>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "logging.h"
+#include "worker.h"
+
+
+worker::worker(const int nr, const std::vector<receiver *> & receivers, const std::vector<ipfix *> & parsers, db *const target, const int cpu, const int queue_size, packet_pool *const pool, std::atomic_bool & stop_flag) :
+	nr(nr),
+	receivers(receivers),
+	parsers(parsers),
+	target(target),
+	cpu(cpu),
+	pool(pool),
+	stop_flag(stop_flag)
+{
+	if (queue_size > 0) {
+		queue = new spsc_queue<packet_t>(queue_size);
+
+		th_process = new std::thread([this] { this->run_process(); });
+	}
+
+	th = new std::thread([this] { this->run(); });
+}
+
+worker::~worker()
+{
+	th->join();
+	delete th;
+
+	if (th_process) {
+		th_process->join();
+		delete th_process;
+
+		dolog(ll_info, "worker::~worker: worker %d queue high-water mark: %zu of %zu, overflows: %lu", nr, queue->get_high_water_mark(), queue->get_size(), queue->get_n_overflows());
+
+		delete queue;
+	}
+
+	for(auto i : parsers)
+		delete i;
+
+	for(auto r : receivers)
+		delete r;
+}
+
+void worker::process(const packet_t & p)
+{
+	// the parsers report errors by returning false; this catches what
+	// remains of the (throwing) buffer class, so that one malformed
+	// packet does not stop the worker
+	try {
+		if (parsers.at(p.listener)->process_packet(p, target) == false)
+			dolog(ll_error, "worker::process: problem processing ipfix packet");
+	}
+	catch(const std::out_of_range & e) {
+		dolog(ll_warning, "worker::process: malformed packet (%s)", e.what());
+	}
+}
+
+void worker::check_kernel_drops(receiver *const r, uint64_t *const reported_drops)
+{
+	uint64_t n_drops = r->get_n_kernel_drops();
+
+	if (n_drops == *reported_drops)
+		return;
+
+	dolog(ll_warning, "worker::check_kernel_drops: kernel dropped %lu datagrams for worker %d on socket %d (%lu in total)", n_drops - *reported_drops, nr, r->get_fd(), n_drops);
+
+	*reported_drops = n_drops;
+
+	int new_size = r->grow_receive_buffer();
+
+	if (new_size != -1)
+		dolog(ll_info, "worker::check_kernel_drops: receive buffer of socket %d grown to %d bytes", r->get_fd(), new_size);
+}
+
+void worker::receive(receiver *const r, const int listener, std::vector<packet_t> & packets)
+{
+	packets.clear();
+
+	if (r->receive(packets) == false)
+		return;
+
+	if (queue) {
+		// when the queue is full, the datagram is dropped (and counted)
+		for(auto & p : packets) {
+			packet_t *slot = queue->get_write_slot();
+			if (!slot)
+				continue;
+
+			// datagrams that are still in receiver owned memory (io_uring,
+			// capture) are copied so that the receiver can re-use it
+			if (!p.buffer) {
+				p.buffer = pool->get(p.data, p.len);
+				p.data   = p.buffer.get();
+			}
+
+			p.listener = listener;
+
+			*slot = std::move(p);
+
+			queue->push();
+		}
+
+		queue->notify();
+	}
+	else {
+		for(auto & p : packets) {
+			p.listener = listener;
+
+			process(p);
+		}
+	}
+
+	r->release();
+}
+
+void worker::run()
+{
+	if (cpu != -1) {
+		cpu_set_t cpuset;
+		CPU_ZERO(&cpuset);
+		CPU_SET(cpu, &cpuset);
+
+		int rc = pthread_setaffinity_np(pthread_self(), sizeof cpuset, &cpuset);
+		if (rc)
+			dolog(ll_warning, "worker::run: cannot pin worker %d to cpu %d: %s", nr, cpu, strerror(rc));
+		else
+			dolog(ll_debug, "worker::run: worker %d pinned to cpu %d", nr, cpu);
+	}
+
+	dolog(ll_info, "worker::run: worker %d started (%zu socket(s))", nr, receivers.size());
+
+	const size_t n_receivers = receivers.size();
+
+	std::vector<struct pollfd> fds;
+	bool busy_polling = false;
+
+	for(auto r : receivers) {
+		fds.push_back({ r->get_fd(), POLLIN, 0 });
+
+		busy_polling |= r->is_busy_polling();
+	}
+
+	std::vector<packet_t> packets;
+
+	std::vector<uint64_t> reported_drops;
+	for(auto r : receivers)
+		reported_drops.push_back(r->get_n_kernel_drops());
+
+	time_t reported = time(nullptr);
+
+	try {
+		while(!stop_flag) {
+			time_t now = time(nullptr);
+
+			if (now - reported >= 10) {
+				for(size_t idx=0; idx<n_receivers; idx++)
+					check_kernel_drops(receivers[idx], &reported_drops[idx]);
+
+				reported = now;
+			}
+
+			if (busy_polling) {
+				// busy polling receivers return without data when there is none
+				for(size_t idx=0; idx<n_receivers; idx++)
+					receive(receivers[idx], idx, packets);
+
+				continue;
+			}
+
+			int rcp = poll(fds.data(), fds.size(), 500);
+
+			if (rcp == 0)  // timeout
+				continue;
+
+			if (rcp == -1) {
+				if (errno == EINTR)
+					continue;
+
+				dolog(ll_error, "worker::run: problem polling for UDP packets: %s", strerror(errno));
+				break;
+			}
+
+			for(size_t idx=0; idx<n_receivers; idx++) {
+				if (fds[idx].revents)
+					receive(receivers[idx], idx, packets);
+			}
+		}
+	}
+	catch(const std::out_of_range & e) {
+		dolog(ll_error, "worker::run: 'out of range' exception (%s); internal error", e.what());
+	}
+	catch(const std::string & e) {
+		dolog(ll_error, "worker::run: an error occured: \"%s\"", e.c_str());
+	}
+
+	dolog(ll_info, "worker::run: worker %d terminating", nr);
+
+	// make sure the other workers and main() stop as well
+	stop_flag = true;
+}
+
+void worker::run_process()
+{
+	uint64_t reported_overflows = 0;
+	time_t   reported           = time(nullptr);
+
+	try {
+		while(!stop_flag) {
+			if (queue->wait(500) == false)
+				continue;
+
+			packet_t *slot = nullptr;
+
+			while((slot = queue->get_read_slot()) != nullptr) {
+				process(*slot);
+
+				// back to the pool unless a record still refers to it
+				slot->buffer.reset();
+
+				queue->pop();
+			}
+
+			time_t now = time(nullptr);
+
+			if (now - reported >= 60) {
+				uint64_t n_overflows = queue->get_n_overflows();
+
+				if (n_overflows != reported_overflows)
+					dolog(ll_warning, "worker::run_process: worker %d dropped %lu datagrams (queue full), high-water mark: %zu of %zu", nr, n_overflows - reported_overflows, queue->get_high_water_mark(), queue->get_size());
+
+				reported_overflows = n_overflows;
+				reported           = now;
+			}
+		}
+	}
+	catch(const std::out_of_range & e) {
+		dolog(ll_error, "worker::run_process: 'out of range' exception (%s); internal error", e.what());
+	}
+	catch(const std::string & e) {
+		dolog(ll_error, "worker::run_process: an error occured: \"%s\"", e.c_str());
+	}
+
+	stop_flag = true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "db.h"
+#include "ipfix.h"
+#include "packet-pool.h"
+#include "receiver.h"
+#include "spsc-queue.h"
+
+
+class worker
+{
+private:
+	const int               nr;
+	// one receiver and parser per listener (see packet_t::listener)
+	std::vector<receiver *> receivers;
+	std::vector<ipfix *>    parsers;
+	db               *const target;
+	const int               cpu;
+	packet_pool      *const pool;
+	std::atomic_bool       &stop_flag;
+
+	// between receive thread and parse/store thread, if any
+	spsc_queue<packet_t>   *queue      { nullptr };
+
+	std::thread            *th         { nullptr };
+	std::thread            *th_process { nullptr };
+
+	void process(const packet_t & p);
+	// logs new kernel drops and (in adaptive mode) grows the receive buffer
+	void check_kernel_drops(receiver *const r, uint64_t *const reported_drops);
+	void receive(receiver *const r, const int listener, std::vector<packet_t> & packets);
+
+	void run();
+	void run_process();
+
+public:
+	// takes ownership of the receivers and parsers, not of 'target' (which may be shared)
+	// and 'pool' (which must outlive the records that were stored)
+	// cpu: -1 to not pin the (receive-)thread to a cpu
+	// queue_size: 0 to receive, parse and store in one thread, else the number
+	// of datagrams that can be buffered between receiving and parsing
+	worker(const int nr, const std::vector<receiver *> & receivers, const std::vector<ipfix *> & parsers, db *const target, const int cpu, const int queue_size, packet_pool *const pool, std::atomic_bool & stop_flag);
+	virtual ~worker();
+};
@@ -74,3 +74,27 @@ bool yaml_get_bool(const YAML::Node & node, const std::string & key, const std::
 		throw myformat("yaml_get_bool: item \"%s\" (%s) is missing in YAML file", key.c_str(), description.c_str());
 	}
 }
+
+std::string yaml_get_string(const YAML::Node & node, const std::string & key, const std::string & description, const std::string & default_value)
+{
+	if (!node[key])
+		return default_value;
+
+	return yaml_get_string(node, key, description);
+}
+
+int yaml_get_int(const YAML::Node & node, const std::string & key, const std::string & description, const int default_value)
+{
+	if (!node[key])
+		return default_value;
+
+	return yaml_get_int(node, key, description);
+}
+
+bool yaml_get_bool(const YAML::Node & node, const std::string & key, const std::string & description, const bool default_value)
+{
+	if (!node[key])
+		return default_value;
+
+	return yaml_get_bool(node, key, description);
+}
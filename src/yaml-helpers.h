@@ -9,3 +9,8 @@ int              yaml_get_int      (const YAML::Node & node, const std::string &
 uint64_t         yaml_get_uint64_t (const YAML::Node & node, const std::string & key, const std::string & description, const bool units);
 const YAML::Node yaml_get_yaml_node(const YAML::Node & node, const std::string & key, const std::string & description);
 bool             yaml_get_bool     (const YAML::Node & node, const std::string & key, const std::string & description);
+
+// same as above but return 'default_value' when the item is not set
+std::string      yaml_get_string   (const YAML::Node & node, const std::string & key, const std::string & description, const std::string & default_value);
+int              yaml_get_int      (const YAML::Node & node, const std::string & key, const std::string & description, const int default_value);
+bool             yaml_get_bool     (const YAML::Node & node, const std::string & key, const std::string & description, const bool default_value);